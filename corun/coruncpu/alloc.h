@@ -0,0 +1,204 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "topology.h"
+
+// the generator's buffer, mapped so that page walks stay out of the
+// bandwidth numbers: transparent huge pages (madvise), explicit hugetlbfs
+// pages (MAP_HUGETLB, from the pool in /proc/sys/vm/nr_hugepages), or small
+// pages, optionally bound to NUMA nodes with mbind(2). Nothing is touched
+// here; the threads fault the pages in, so binding and huge pages apply to
+// the first touch. buffer_report() reads back what the kernel actually gave.
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#define MPOL_INTERLEAVE 3
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#define MADV_NOHUGEPAGE 15
+#endif
+
+#define MAX_NODES 1024
+#define THP_SIZE (2UL << 20)
+
+enum page_mode { PAGES_DEFAULT, PAGES_SMALL, PAGES_THP, PAGES_HUGETLB, PAGES_COUNT };
+
+static const char *page_mode_names[PAGES_COUNT] = {"default", "small", "thp", "hugetlb"};
+
+struct buffer {
+  void *base;                // the mapping
+  size_t len;
+  enum page_mode mode;       // what was mapped, after any fallback
+  const char *nodes;         // NULL: first touch decides
+};
+
+// returns 0, or -1 for an unknown name
+static int page_mode_parse(const char *name, enum page_mode *mode)
+{
+  int k;
+  for (k = 0; k < PAGES_COUNT; ++k) {
+    if (strcmp(name, page_mode_names[k]) == 0) {
+      *mode = (enum page_mode)k;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+// first "Hugepagesize" of /proc/meminfo, in bytes
+static size_t hugetlb_page_size(void)
+{
+  char line[256];
+  size_t kb = 0;
+  FILE *fp = fopen("/proc/meminfo", "r");
+  if (fp == NULL) return THP_SIZE;
+  while (fgets(line, sizeof(line), fp))
+    if (sscanf(line, "Hugepagesize: %zu kB", &kb) == 1) break;
+  fclose(fp);
+  return kb ? kb << 10 : THP_SIZE;
+}
+
+// MPOL_BIND to one node, MPOL_INTERLEAVE across several ("0", "0-1", "0,2")
+static int bind_nodes(void *base, size_t len, const char *nodes)
+{
+  static int list[MAX_NODES];
+  unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))];
+  int n = parse_cpulist(nodes, list, MAX_NODES), k;
+  if (n <= 0) {
+    fprintf(stderr, "bad node list %s\n", nodes);
+    return -1;
+  }
+  memset(mask, 0, sizeof(mask));
+  for (k = 0; k < n; ++k) {
+    if (list[k] >= MAX_NODES) return -1;
+    mask[list[k] / (8 * sizeof(unsigned long))] |= 1UL << (list[k] % (8 * sizeof(unsigned long)));
+  }
+  if (syscall(SYS_mbind, base, len, n == 1 ? MPOL_BIND : MPOL_INTERLEAVE, mask,
+              (unsigned long)MAX_NODES, MPOL_MF_MOVE) != 0) {
+    perror("mbind");
+    return -1;
+  }
+  return 0;
+}
+
+// map len bytes; a hugetlb request falls back to THP when the pool is empty,
+// with a message. returns 0, or -1
+static int buffer_alloc(struct buffer *b, size_t len, enum page_mode mode, const char *nodes)
+{
+  int prot = PROT_READ | PROT_WRITE, flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  b->base = MAP_FAILED;
+  b->nodes = nodes;
+
+  if (mode == PAGES_HUGETLB) {
+    size_t page = hugetlb_page_size(), rounded = (len + page - 1) / page * page;
+    b->base = mmap(NULL, rounded, prot, flags | MAP_HUGETLB, -1, 0);
+    if (b->base != MAP_FAILED) {
+      b->len = rounded;
+    } else {
+      fprintf(stderr, "no hugetlb pages (see /proc/sys/vm/nr_hugepages), using thp\n");
+      mode = PAGES_THP;
+    }
+  }
+  if (b->base == MAP_FAILED && mode == PAGES_THP) {
+    // align to a huge page so the whole range can be backed by them
+    size_t over = len + THP_SIZE;
+    char *raw = (char *)mmap(NULL, over, prot, flags, -1, 0), *start;
+    if (raw == MAP_FAILED) {
+      perror("mmap");
+      return -1;
+    }
+    start = (char *)(((uintptr_t)raw + THP_SIZE - 1) & ~(uintptr_t)(THP_SIZE - 1));
+    if (start > raw) munmap(raw, start - raw);
+    if (raw + over > start + len) munmap(start + len, raw + over - (start + len));
+    b->base = start;
+    b->len = len;
+    if (madvise(start, len, MADV_HUGEPAGE) != 0) perror("madvise(MADV_HUGEPAGE)");
+  }
+  if (b->base == MAP_FAILED) {
+    b->base = mmap(NULL, len, prot, flags, -1, 0);
+    if (b->base == MAP_FAILED) {
+      perror("mmap");
+      return -1;
+    }
+    b->len = len;
+    if (mode == PAGES_SMALL && madvise(b->base, len, MADV_NOHUGEPAGE) != 0)
+      perror("madvise(MADV_NOHUGEPAGE)");
+  }
+  b->mode = mode;
+
+  if (nodes && bind_nodes(b->base, b->len, nodes) != 0) {
+    munmap(b->base, b->len);
+    return -1;
+  }
+  return 0;
+}
+
+static void buffer_free(struct buffer *b)
+{
+  if (b->base != MAP_FAILED && b->base != NULL) munmap(b->base, b->len);
+  b->base = NULL;
+}
+
+// one "PAGES" line: the mode, the kernel page size of the mapping, how much
+// of it is resident and how much of that is in transparent huge pages (all
+// from /proc/self/smaps), and one "NUMA" line with the resident pages per
+// node from /proc/self/numa_maps. Call after the first touch.
+static void buffer_report(const struct buffer *b, FILE *out)
+{
+  char line[4096];
+  unsigned long lo, hi, start = (unsigned long)b->base, vma[64];
+  size_t page_kb = 0, rss_kb = 0, thp_kb = 0, v;
+  int in = 0, nvma = 0, k;
+  FILE *fp = fopen("/proc/self/smaps", "r");
+
+  if (fp) {
+    while (fgets(line, sizeof(line), fp)) {
+      if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2 && strchr(line, '-') < strchr(line, ' ')) {
+        if (in && lo >= start + b->len) break;
+        // the mapping may have been merged into a neighbour or split up
+        in = lo < start + b->len && hi > start;
+        if (in && nvma < 64) vma[nvma++] = lo;
+      } else if (in) {
+        if (sscanf(line, "KernelPageSize: %zu kB", &v) == 1) page_kb = v;
+        else if (sscanf(line, "Rss: %zu kB", &v) == 1) rss_kb += v;
+        else if (sscanf(line, "AnonHugePages: %zu kB", &v) == 1) thp_kb += v;
+      }
+    }
+    fclose(fp);
+  }
+  fprintf(out, "PAGES mode %s page_kb %zu rss_kb %zu thp_kb %zu\n",
+          page_mode_names[b->mode], page_kb, rss_kb, thp_kb);
+
+  fp = fopen("/proc/self/numa_maps", "r");
+  if (fp) {
+    fprintf(out, "NUMA policy %s", b->nodes ? b->nodes : "first_touch");
+    while (fgets(line, sizeof(line), fp)) {
+      char *tok;
+      if (sscanf(line, "%lx", &lo) != 1) continue;
+      for (k = 0; k < nvma && vma[k] != lo; ++k) ;
+      if (k == nvma) continue;
+      // "N<node>=<pages>", once per VMA
+      for (tok = strtok(line, " \n"); tok; tok = strtok(NULL, " \n"))
+        if (tok[0] == 'N' && strchr(tok, '=')) fprintf(out, " %s", tok);
+    }
+    fprintf(out, "\n");
+    fclose(fp);
+  }
+}
+
+#endif
@@ -1,14 +1,29 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <sys/time.h>
 #include <inttypes.h>
 #include <omp.h>
-#define ERT_FLOP 2 
+
+#include "alloc.h"
+#include "simd.h"
+#include "topology.h"
 #define ERT_TRIALS_MIN 1
 #define ERT_WORKING_SET_MIN 1
 #define GBUNIT (1024 * 1024 * 1024)
 
+// target mode: elements per kernel call, and the controller's gains
+#define TARGET_CHUNK (1 << 13)
+#define TARGET_KP 0.5
+#define TARGET_KI 5.0
+
+// STREAM triad passes for -S; the best one is the peak
+#define STREAM_NTIMES 5
+
 #define REP2(S)        S ;        S
 #define REP4(S)   REP2(S);   REP2(S)
 #define REP8(S)   REP4(S);   REP4(S) 
@@ -32,6 +47,86 @@ void initialize(uint64_t nsize,
   }
 }
 
+// unroll hint for the element loops, in each compiler's own spelling
+#if defined(__clang__)
+#define UNROLL_8 _Pragma("unroll 8")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define UNROLL_8 _Pragma("GCC unroll 8")
+#else
+#define UNROLL_8
+#endif
+
+// one kernel per arithmetic intensity, each with its flops unrolled at
+// compile time as in the ERT: KERNEL1 for 1 flop per element, KERNEL2 (2
+// flops) repeated for the rest. Every element is read and written once.
+#define DEFINE_KERNEL(F, BODY)                                          \
+static void kernel_##F(uint64_t nsize, uint64_t ntrials,                \
+                       double* __restrict__ A)                          \
+{                                                                       \
+  double alpha = 0.5;                                                   \
+  uint64_t i, j;                                                        \
+  for (j = 0; j < ntrials; ++j) {                                       \
+    UNROLL_8                                                            \
+    for (i = 0; i < nsize; ++i) {                                       \
+      double beta = 0.8;                                                \
+      BODY;                                                             \
+      A[i] = beta;                                                      \
+    }                                                                   \
+    alpha = alpha * (1 - 1e-8);                                         \
+  }                                                                     \
+}
+
+DEFINE_KERNEL(1,    KERNEL1(beta,A[i],alpha))
+DEFINE_KERNEL(2,    KERNEL2(beta,A[i],alpha))
+DEFINE_KERNEL(4,    REP2(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(8,    REP4(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(16,   REP8(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(32,   REP16(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(64,   REP32(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(128,  REP64(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(256,  REP128(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(512,  REP256(KERNEL2(beta,A[i],alpha)))
+DEFINE_KERNEL(1024, REP512(KERNEL2(beta,A[i],alpha)))
+
+typedef void (*kernel_fn)(uint64_t, uint64_t, double* __restrict__);
+
+struct kernel_entry {
+  int flops;
+  kernel_fn fn;
+};
+
+static const struct kernel_entry kernels[] = {
+  {1, kernel_1}, {2, kernel_2}, {4, kernel_4}, {8, kernel_8},
+  {16, kernel_16}, {32, kernel_32}, {64, kernel_64}, {128, kernel_128},
+  {256, kernel_256}, {512, kernel_512}, {1024, kernel_1024},
+};
+#define NKERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+// flops per element, chosen with -f; the call through the table happens
+// once per kernel() call, outside the element loop
+int ert_flops = 2;
+static kernel_fn selected_kernel = kernel_2;
+
+int select_kernel(int flops)
+{
+  unsigned k;
+  for (k = 0; k < NKERNELS; ++k) {
+    if (kernels[k].flops == flops) {
+      ert_flops = flops;
+      selected_kernel = kernels[k].fn;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+// -v: a hand-vectorized 2-flop kernel (simd.h) replaces the table's when set;
+// the default stays the compiler-vectorized one, as run_ert_pair.sh was measured with
+enum bw_isa kernel_isa = ISA_SCALAR;
+static bw_kernel_fn simd_kernel = NULL;
+int nt_stores = 0;
+uint64_t prefetch_bytes = 0;
+
 void kernel(uint64_t nsize,
             uint64_t ntrials,
             double* __restrict__ A,
@@ -40,46 +135,12 @@ void kernel(uint64_t nsize,
 {
   *bytes_per_elem        = sizeof(*A);
   *mem_accesses_per_elem = 2;
-
-  double alpha = 0.5;
-  uint64_t i, j;
-  for (j = 0; j < ntrials; ++j) {
-#pragma unroll (8)
-  for (i = 0; i < nsize; ++i) {
-      double beta = 0.8;
-//if ((ERT_FLOP & 2) == 2)       /* add 2 flops */
-//      KERNEL2(beta,A[i],alpha);
-//      KERNEL2(beta,A[i],alpha);
-//      KERNEL2(beta,A[i],alpha);
-      KERNEL2(beta,A[i],alpha);
-//      KERNEL1(beta,A[i],alpha);
-//      KERNEL1(beta,A[i],alpha);
-
-//if ((ERT_FLOP & 4) == 4)       /* add 4 flops */
-//      REP2(KERNEL2(beta,A[i],alpha));
-//        REP2(KERNEL2(beta,A[i],alpha));
-//if ((ERT_FLOP & 8) == 8)       /* add 8 flops */
-//        REP4(KERNEL2(beta,A[i],alpha));
-//      REP4(KERNEL2(beta,A[i],alpha));
-//  if ((ERT_FLOP & 16) == 16)     /* add 16 flops */
-//      REP8(KERNEL2(beta,A[i],alpha));
-//if ((ERT_FLOP & 32) == 32 )    /* add 32 flops */      
-//        REP16(KERNEL2(beta,A[i],alpha));
-//if ((ERT_FLOP & 64) == 64)     /* add 64 flops */
-//      REP32(KERNEL2(beta,A[i],alpha));
-//if ((ERT_FLOP & 128) == 128)   /* add 128 flops */
-//      REP64(KERNEL2(beta,A[i],alpha));
-//if ((ERT_FLOP & 256) == 256)   /* add 256 flops */
-//      REP128(KERNEL2(beta,A[i],alpha));
-//if ((ERT_FLOP & 512) == 512)   /* add 512 flops */
-//      REP256(KERNEL2(beta,A[i],alpha));
-//if ((ERT_FLOP & 1024) == 1024) /* add 1024 flops */
-//     REP512(KERNEL2(beta,A[i],alpha));
-      A[i] = beta;
-    }
-    alpha = alpha * (1 - 1e-8);
-  }
+  if (simd_kernel)
+    simd_kernel(nsize, ntrials, A, nt_stores, prefetch_bytes);
+  else
+    selected_kernel(nsize, ntrials, A);
 }
+
 double getTime()
 {
 		double time;
@@ -87,27 +148,277 @@ double getTime()
 		return time;
 }
 
+// -S: best STREAM triad bandwidth over the buffer, in the unit of the BW:
+// lines; 0 when not measured. Each thread runs the triad on three thirds of
+// its own share, then restores the share's initial values.
+double stream_peak = 0;
+
+void stream_triad(uint64_t nsize, double* __restrict__ A, int id, int nthreads)
+{
+		static double start;
+		uint64_t n = nsize / 3, i;
+		double *a = A, *b = A + n, *c = A + 2 * n;
+		int k;
+
+		for (k = 0; k < STREAM_NTIMES; ++k) {
+#pragma omp barrier
+				if (id == 0) start = getTime();
+				for (i = 0; i < n; ++i) a[i] = b[i] + 3.0 * c[i];
+#pragma omp barrier
+				if (id == 0) {
+						// STREAM counts 3 words per element, no write-allocate
+						double bw = 3.0 * sizeof(double) * n * nthreads / (getTime() - start) / GBUNIT;
+						if (bw > stream_peak) stream_peak = bw;
+				}
+		}
+		initialize(nsize, A, 1.0);
+}
+
+// -t / -P: thread count and where the threads are pinned (unpinned when
+// pin_policy is NULL). thread_cpu[] is the CPU each thread ran on once pinned.
+int req_threads = 7;
+const char *pin_policy = NULL;
+static struct cpu_info topo[MAX_CPUS];
+static int ntopo = 0, npin = 0, pin_cpus[MAX_CPUS];
+static int *thread_cpu;
+
+// called by every thread first, so the buffer is first touched in place
+void place_thread(int id, int nthreads)
+{
+		if (npin == 0) return;
+		if (pin_thread(pin_cpus[id % npin]) != 0)
+				fprintf(stderr, "thread %d: cannot pin to cpu %d\n", id, pin_cpus[id % npin]);
+		thread_cpu[id] = sched_getcpu();
+#pragma omp barrier
+		if (id == 0) {
+				int t;
+				for (t = 0; t < nthreads; ++t) {
+						const struct cpu_info *c = find_cpu(topo, ntopo, thread_cpu[t]);
+						printf("PLACEMENT thread %d cpu %d cluster %d capacity %d freq_domain %d max_khz %ld\n",
+						       t, thread_cpu[t], c ? c->cluster : -1, c ? c->capacity : 0,
+						       c ? c->freq_domain : -1, c ? c->max_khz : 0);
+				}
+				fflush(stdout);
+		}
+}
+
+// -H / -N: page size and NUMA placement of the buffer
+enum page_mode buffer_pages = PAGES_DEFAULT;
+const char *buffer_nodes = NULL;
+static struct buffer mem;
+
+void printBW(double bw)
+{
+		printf("BW: %15.3lf", bw);
+		if (stream_peak > 0) printf(" PEAK_FRACTION %.3lf", bw / stream_peak);
+}
+
+void sleepFor(double seconds)
+{
+		struct timespec ts;
+		if (seconds <= 0) return;
+		ts.tv_sec = (time_t)seconds;
+		ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1e9);
+		nanosleep(&ts, NULL);
+}
+
+// target mode: hold a bandwidth (in the unit of the BW: lines) by running
+// the kernel for the first `duty` of every slice and idling for the rest.
+// Thread 0 sets the duty at each slice boundary from the throughput of the
+// previous slice: feed-forward target / (rate while active), plus a PI
+// correction on the error, so the achieved average settles on the target
+// whatever the other PUs leave of the memory system.
+double target_bw = 0;           // 0: sweep working sets flat out as before
+double slice_seconds = 0.010;
+double duration = 0;            // target mode stops after this long; 0 = until killed
+
+static double slice_start, active_until, slice_end, work_end;
+static uint64_t slice_bytes;
+static int target_stop;
+
+static void target_controller(int nthreads, uint64_t nsize, int bytes_per_elem, int mem_accesses_per_elem)
+{
+		static double begin, report_start, duty = 1, rate = 0, integral = 0, active_sum = 0;
+		static uint64_t report_bytes = 0;
+		static int reports = 0;
+		double now = getTime();
+
+		if (begin == 0) {
+				begin = report_start = now;
+		} else {
+				double elapsed = now - slice_start;
+				// the last chunk of a slice may run past active_until
+				double active = work_end - slice_start;
+				double bw = slice_bytes * 1.0 / elapsed / GBUNIT;
+				if (active > 0 && slice_bytes > 0) {
+						double r = slice_bytes * 1.0 / active / GBUNIT;
+						rate = rate > 0 ? 0.8 * rate + 0.2 * r : r;
+				}
+				double error = target_bw - bw;
+				double step = error * elapsed;
+				integral += step;
+				double u = target_bw + TARGET_KP * error + TARGET_KI * integral;
+				duty = rate > 0 ? u / rate : 1;
+				// anti-windup: don't integrate while the duty is saturated
+				if (duty > 1 || duty < 0) integral -= step;
+				if (duty > 1) duty = 1;
+				if (duty < 0) duty = 0;
+				report_bytes += slice_bytes;
+				active_sum += active;
+		}
+
+		if (now - report_start >= 1.0) {
+				double seconds = now - report_start;
+				uint64_t elements = report_bytes / (bytes_per_elem * mem_accesses_per_elem);
+				// same columns as the sweep, one row per second of target mode
+				printf("%12" PRIu64 " %12d %15.3lf %12" PRIu64 " %12" PRIu64 "\n",
+				       nsize * nthreads * bytes_per_elem, ++reports, seconds, report_bytes,
+				       elements * ert_flops);
+				printBW(report_bytes * 1.0 / seconds / GBUNIT);
+				printf(" TARGET %.3lf DUTY %.3lf\n", target_bw, active_sum / seconds);
+				fflush(stdout);
+				report_start = now;
+				report_bytes = 0;
+				active_sum = 0;
+		}
+
+		target_stop = duration > 0 && now - begin >= duration;
+		slice_bytes = 0;
+		slice_start = work_end = now;
+		slice_end = now + slice_seconds;
+		active_until = now + duty * slice_seconds;
+}
+
+// every thread's part of target mode; A is its own nsize elements
+void run_target(uint64_t nsize, double* __restrict__ A, int id, int nthreads)
+{
+		int bytes_per_elem = sizeof(*A), mem_accesses_per_elem = 2;
+		uint64_t chunk = nsize < TARGET_CHUNK ? nsize : TARGET_CHUNK;
+		uint64_t pos = 0;
+
+		for (;;) {
+#pragma omp barrier
+				if (id == 0) target_controller(nthreads, nsize, bytes_per_elem, mem_accesses_per_elem);
+#pragma omp barrier
+				if (target_stop) break;
+
+				// walk the thread's whole share so the traffic goes to DRAM
+				uint64_t bytes = 0;
+				while (getTime() < active_until) {
+						kernel(chunk, 1, A + pos, &bytes_per_elem, &mem_accesses_per_elem);
+						bytes += chunk * bytes_per_elem * mem_accesses_per_elem;
+						pos += chunk;
+						if (pos + chunk > nsize) pos = 0;
+				}
+				double end = getTime();
+#pragma omp atomic
+				slice_bytes += bytes;
+#pragma omp critical
+				if (end > work_end) work_end = end;
+				sleepFor(slice_end - getTime());
+		}
+}
+
+static void usage(const char *prog)
+{
+		unsigned k;
+		fprintf(stderr, "usage: %s [-t threads] [-P policy] [-H pages] [-N nodes] [-f flops] [-v isa [-n] [-p bytes]] [-S] [-b target_bw [-s slice_ms] [-d seconds]]\n", prog);
+		fprintf(stderr, "  without -b: sweep working sets flat out\n");
+		fprintf(stderr, "  -t: OpenMP threads (default 7, or one per selected core with -P)\n");
+		fprintf(stderr, "  -P: pin threads to big, little, spread (clusters in turn), all, or a cpu list like 0-3,6\n");
+		fprintf(stderr, "  -H: buffer pages: default, small, thp (madvise) or hugetlb (MAP_HUGETLB)\n");
+		fprintf(stderr, "  -N: bind the buffer to a NUMA node, or interleave it over a node list like 0-1\n");
+		fprintf(stderr, "  -f: flops per element (default 2), one of");
+		for (k = 0; k < NKERNELS; ++k) fprintf(stderr, " %d", kernels[k].flops);
+		fprintf(stderr, "\n");
+		fprintf(stderr, "  -v: kernel for 2 flops: scalar (default), auto (widest the CPU has), avx2, avx512 or neon\n");
+		fprintf(stderr, "  -n: non-temporal stores, -p: prefetch distance in bytes (vector kernels)\n");
+		fprintf(stderr, "  -S: measure the STREAM triad peak first and report each BW as a fraction of it\n");
+		fprintf(stderr, "  -b: hold target_bw (GB/s, as in the BW: lines) by duty-cycling the kernel\n");
+}
+
 int main(int argc, char *argv[]) {
 
 		int rank = 0;
 		int nprocs = 1;
 		int nthreads = 1;
 		int id = 0;
+		int opt;
+		int auto_isa = 0, stream_check = 0, threads_set = 0;
+
+		while ((opt = getopt(argc, argv, "t:P:H:N:f:v:np:Sb:s:d:")) != -1) {
+				switch (opt) {
+				case 't': req_threads = atoi(optarg); threads_set = 1; break;
+				case 'P': pin_policy = optarg; break;
+				case 'H':
+						if (page_mode_parse(optarg, &buffer_pages) != 0) { usage(argv[0]); return -1; }
+						break;
+				case 'N': buffer_nodes = optarg; break;
+				case 'f':
+						if (select_kernel(atoi(optarg)) != 0) { usage(argv[0]); return -1; }
+						break;
+				case 'v':
+						auto_isa = strcmp(optarg, "auto") == 0;
+						if (!auto_isa && bw_isa_parse(optarg, &kernel_isa) != 0) { usage(argv[0]); return -1; }
+						break;
+				case 'n': nt_stores = 1; break;
+				case 'p': prefetch_bytes = strtoull(optarg, NULL, 10); break;
+				case 'S': stream_check = 1; break;
+				case 'b': target_bw = atof(optarg); break;
+				case 's': slice_seconds = atof(optarg) / 1000; break;
+				case 'd': duration = atof(optarg); break;
+				default: usage(argv[0]); return -1;
+				}
+		}
+		if (target_bw < 0 || slice_seconds <= 0 || req_threads <= 0) {
+				usage(argv[0]);
+				return -1;
+		}
+		if (auto_isa) kernel_isa = ert_flops == 2 ? bw_best_isa() : ISA_SCALAR;
+		if (kernel_isa != ISA_SCALAR) {
+				simd_kernel = bw_kernel(kernel_isa);
+				if (simd_kernel == NULL) {
+						fprintf(stderr, "%s kernel not supported on this CPU or build\n", bw_isa_names[kernel_isa]);
+						return -1;
+				}
+				if (ert_flops != 2) {
+						fprintf(stderr, "vector kernels are 2 flops per element\n");
+						return -1;
+				}
+		} else if (nt_stores || prefetch_bytes) {
+				fprintf(stderr, "-n and -p need a vector kernel (-v)\n");
+				return -1;
+		}
+
+		if (pin_policy) {
+				ntopo = discover_topology(topo, MAX_CPUS);
+				if (ntopo <= 0) {
+						fprintf(stderr, "cannot read the CPU topology from %s\n", SYS_CPU);
+						return -1;
+				}
+				npin = select_cpus(topo, ntopo, pin_policy, pin_cpus);
+				if (npin <= 0) {
+						fprintf(stderr, "no CPUs for placement %s\n", pin_policy);
+						return -1;
+				}
+				if (!threads_set) req_threads = npin;
+				thread_cpu = (int *)calloc(req_threads, sizeof(int));
+		}
 
 		uint64_t TSIZE = 1<<30;
 		uint64_t PSIZE = TSIZE / nprocs;
 
-		double * buf = (double *)malloc(PSIZE);
-
-		if (buf == NULL) {
-				fprintf(stderr, "Out of memory!\n");
+		if (buffer_alloc(&mem, PSIZE, buffer_pages, buffer_nodes) != 0) {
+				fprintf(stderr, "cannot allocate the buffer\n");
+				free(thread_cpu);
 				return -1;
 		}
-#pragma omp parallel private(id) num_threads(7)
-//#pragma omp parallel private(id) 
+		double * buf = (double *)mem.base;
+#pragma omp parallel private(id) num_threads(req_threads)
 		{
 				id = omp_get_thread_num();
 				nthreads = omp_get_num_threads();
+				place_thread(id, nthreads);
 
 				uint64_t nsize = PSIZE / nthreads;
 				nsize = nsize & (~(64-1));
@@ -116,66 +427,83 @@ int main(int argc, char *argv[]) {
 
 				// initialize small chunck of buffer within each thread
 				initialize(nsize, &buf[nid], 1.0);
+#pragma omp barrier
+				if (id == 0) {
+						buffer_report(&mem, stdout);
+						fflush(stdout);
+				}
+				if (stream_check) stream_triad(nsize, &buf[nid], id, nthreads);
+
+				if (target_bw > 0) {
+						run_target(nsize, &buf[nid], id, nthreads);
+				} else {
+						double startTime, endTime;
+						uint64_t n,nNew;
+						uint64_t t;
+						int bytes_per_elem;
+						int mem_accesses_per_elem;
 
+						n = 1<<22;
+						while (n <= nsize) { // working set - nsize
+								uint64_t ntrials = nsize / n;
+								if (ntrials < 1)
+										ntrials = 1;
 
-				double startTime, endTime;
-				uint64_t n,nNew;
-				uint64_t t;
-				int bytes_per_elem;
-				int mem_accesses_per_elem;
+								for (t = 1; t <= 600; t = t + 1) { // working set - ntrials
+						#pragma omp barrier
 
-				n = 1<<22;
-				while (n <= nsize) { // working set - nsize
-						uint64_t ntrials = nsize / n;
-						if (ntrials < 1)
-								ntrials = 1;
+										if ((id == 0) && (rank==0)) {
+												startTime = getTime();
+										}
+										// C-code
+										kernel(n, t, &buf[nid], &bytes_per_elem, &mem_accesses_per_elem);
 
-						for (t = 1; t <= 600; t = t + 1) { // working set - ntrials
-				#pragma omp barrier
+						#pragma omp barrier
 
-								if ((id == 0) && (rank==0)) {
-										startTime = getTime();
+										if ((id == 0) && (rank == 0)) {
+												endTime = getTime();
+												double seconds = (double)(endTime - startTime);
+												uint64_t working_set_size = n * nthreads * nprocs;
+												uint64_t total_bytes = t * working_set_size * bytes_per_elem * mem_accesses_per_elem;
+												uint64_t total_flops = t * working_set_size * ert_flops;
+												// nsize; trials; microseconds; bytes; single thread bandwidth; total bandwidth
+												printf("%12" PRIu64 " %12" PRIu64 " %15.3lf %12" PRIu64 " %12" PRIu64 "\n",
+												       working_set_size * bytes_per_elem,
+												       t,
+												       seconds,
+												       total_bytes,
+												       total_flops);
+														printBW(total_bytes*1.0/seconds/GBUNIT);
+														printf("\n");
+										} // print
+								} // working set - ntrials
+
+								nNew = 2 * n;
+								if (nNew == n) {
+										nNew = n+1;
 								}
-								// C-code
-								kernel(n, t, &buf[nid], &bytes_per_elem, &mem_accesses_per_elem);
-
-				#pragma omp barrier
-
-								if ((id == 0) && (rank == 0)) {
-										endTime = getTime();
-										double seconds = (double)(endTime - startTime);
-										uint64_t working_set_size = n * nthreads * nprocs;
-										uint64_t total_bytes = t * working_set_size * bytes_per_elem * mem_accesses_per_elem;
-										uint64_t total_flops = t * working_set_size * ERT_FLOP;
-										// nsize; trials; microseconds; bytes; single thread bandwidth; total bandwidth
-										printf("%12" PRIu64 " %12" PRIu64 " %15.3lf %12" PRIu64 " %12" PRIu64 "\n",
-										       working_set_size * bytes_per_elem,
-										       t,
-										       seconds,
-										       total_bytes,
-										       total_flops);
-                                        printf("BW: %15.3lf\n",total_bytes*1.0/seconds/1024/1024/1024);
-								} // print
-						} // working set - ntrials
-
-						nNew = 2 * n;
-						if (nNew == n) {
-								nNew = n+1;
-						}
-
-						n = nNew;
-				} // working set - nsize
+
+								n = nNew;
+						} // working set - nsize
+				} // sweep
 
 		} // parallel region
 
-		free(buf);
+		buffer_free(&mem);
+		free(thread_cpu);
 
 
 		printf("\n");
 		printf("META_DATA\n");
-		printf("FLOPS          %d\n", ERT_FLOP);
+		printf("FLOPS          %d\n", ert_flops);
 
 		printf("OPENMP_THREADS %d\n", nthreads);
+		if (pin_policy) printf("PLACEMENT      %s\n", pin_policy);
+		printf("PAGES          %s\n", page_mode_names[mem.mode]);
+		printf("KERNEL         %s\n", bw_isa_names[kernel_isa]);
+		printf("NT_STORES      %d\n", nt_stores);
+		printf("PREFETCH       %" PRIu64 "\n", prefetch_bytes);
+		if (stream_peak > 0) printf("STREAM_TRIAD   %.3lf\n", stream_peak);
 
 
 		return 0;
@@ -0,0 +1,165 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_KERNEL 1
+#endif
+
+// hand-vectorized versions of the 2-flop kernel, A[i] = 0.8 * A[i] + alpha,
+// one 64-byte cache line per iteration. nt writes the results with
+// streaming (non-temporal) stores, so no write-allocate traffic competes for
+// DRAM; prefetch > 0 prefetches that many bytes ahead of the loads.
+// Each pass runs scalar up to the first line boundary and after the last.
+
+enum bw_isa { ISA_SCALAR, ISA_AVX2, ISA_AVX512, ISA_NEON, ISA_COUNT };
+
+typedef void (*bw_kernel_fn)(uint64_t nsize, uint64_t ntrials, double* __restrict__ A,
+                             int nt, uint64_t prefetch);
+
+#define BW_LINE 64
+
+// elements before A + head are scalar, up to the first cache line boundary
+static inline uint64_t bw_head(uint64_t nsize, const double *A)
+{
+  uint64_t head = ((BW_LINE - ((uintptr_t)A & (BW_LINE - 1))) & (BW_LINE - 1)) / sizeof(*A);
+  return head < nsize ? head : nsize;
+}
+
+#ifdef HAVE_X86_KERNELS
+
+__attribute__((target("avx2,fma")))
+static void bw_avx2(uint64_t nsize, uint64_t ntrials, double* __restrict__ A,
+                    int nt, uint64_t prefetch)
+{
+  double alpha = 0.5;
+  uint64_t i, j, head = bw_head(nsize, A);
+  __m256d b = _mm256_set1_pd(0.8);
+  for (j = 0; j < ntrials; ++j) {
+    __m256d a = _mm256_set1_pd(alpha);
+    for (i = 0; i < head; ++i) A[i] = 0.8 * A[i] + alpha;
+    for (; i + 8 <= nsize; i += 8) {
+      if (prefetch) _mm_prefetch((const char *)(A + i) + prefetch, _MM_HINT_T0);
+      __m256d v0 = _mm256_fmadd_pd(_mm256_load_pd(A + i), b, a);
+      __m256d v1 = _mm256_fmadd_pd(_mm256_load_pd(A + i + 4), b, a);
+      if (nt) {
+        _mm256_stream_pd(A + i, v0);
+        _mm256_stream_pd(A + i + 4, v1);
+      } else {
+        _mm256_store_pd(A + i, v0);
+        _mm256_store_pd(A + i + 4, v1);
+      }
+    }
+    for (; i < nsize; ++i) A[i] = 0.8 * A[i] + alpha;
+    alpha = alpha * (1 - 1e-8);
+  }
+  if (nt) _mm_sfence();
+}
+
+__attribute__((target("avx512f")))
+static void bw_avx512(uint64_t nsize, uint64_t ntrials, double* __restrict__ A,
+                      int nt, uint64_t prefetch)
+{
+  double alpha = 0.5;
+  uint64_t i, j, head = bw_head(nsize, A);
+  __m512d b = _mm512_set1_pd(0.8);
+  for (j = 0; j < ntrials; ++j) {
+    __m512d a = _mm512_set1_pd(alpha);
+    for (i = 0; i < head; ++i) A[i] = 0.8 * A[i] + alpha;
+    for (; i + 8 <= nsize; i += 8) {
+      if (prefetch) _mm_prefetch((const char *)(A + i) + prefetch, _MM_HINT_T0);
+      __m512d v = _mm512_fmadd_pd(_mm512_load_pd(A + i), b, a);
+      if (nt) _mm512_stream_pd(A + i, v);
+      else _mm512_store_pd(A + i, v);
+    }
+    for (; i < nsize; ++i) A[i] = 0.8 * A[i] + alpha;
+    alpha = alpha * (1 - 1e-8);
+  }
+  if (nt) _mm_sfence();
+}
+
+#endif
+
+#ifdef HAVE_NEON_KERNEL
+
+static void bw_neon(uint64_t nsize, uint64_t ntrials, double* __restrict__ A,
+                    int nt, uint64_t prefetch)
+{
+  double alpha = 0.5;
+  uint64_t i, j, k, head = bw_head(nsize, A);
+  float64x2_t b = vdupq_n_f64(0.8);
+  for (j = 0; j < ntrials; ++j) {
+    float64x2_t a = vdupq_n_f64(alpha);
+    for (i = 0; i < head; ++i) A[i] = 0.8 * A[i] + alpha;
+    for (; i + 8 <= nsize; i += 8) {
+      float64x2_t v[4];
+      if (prefetch) __builtin_prefetch((const char *)(A + i) + prefetch, 0, 0);
+      for (k = 0; k < 4; ++k) v[k] = vfmaq_f64(a, vld1q_f64(A + i + 2 * k), b);
+      if (nt) {
+        // STNP: store pair, non-temporal hint
+        __asm__ volatile("stnp %q0, %q1, [%2]\n\tstnp %q3, %q4, [%2, #32]"
+                         :: "w"(v[0]), "w"(v[1]), "r"(A + i), "w"(v[2]), "w"(v[3]) : "memory");
+      } else {
+        for (k = 0; k < 4; ++k) vst1q_f64(A + i + 2 * k, v[k]);
+      }
+    }
+    for (; i < nsize; ++i) A[i] = 0.8 * A[i] + alpha;
+    alpha = alpha * (1 - 1e-8);
+  }
+}
+
+#endif
+
+// the kernel for one instruction set, or NULL if this build or CPU lacks it;
+// ISA_SCALAR has none here, it is the compiler-vectorized kernel table
+static bw_kernel_fn bw_kernel(enum bw_isa isa)
+{
+  switch (isa) {
+#ifdef HAVE_X86_KERNELS
+  case ISA_AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? bw_avx2 : NULL;
+  case ISA_AVX512:
+    return __builtin_cpu_supports("avx512f") ? bw_avx512 : NULL;
+#endif
+#ifdef HAVE_NEON_KERNEL
+  case ISA_NEON:
+    return bw_neon;
+#endif
+  default:
+    return NULL;
+  }
+}
+
+// widest instruction set usable on this CPU
+static enum bw_isa bw_best_isa(void)
+{
+  const enum bw_isa order[] = {ISA_AVX512, ISA_AVX2, ISA_NEON};
+  unsigned k;
+  for (k = 0; k < sizeof(order) / sizeof(order[0]); ++k)
+    if (bw_kernel(order[k])) return order[k];
+  return ISA_SCALAR;
+}
+
+static const char *bw_isa_names[ISA_COUNT] = {"scalar", "avx2", "avx512", "neon"};
+
+// returns 0, or -1 for an unknown name
+static int bw_isa_parse(const char *name, enum bw_isa *isa)
+{
+  int k;
+  for (k = 0; k < ISA_COUNT; ++k) {
+    if (strcmp(name, bw_isa_names[k]) == 0) {
+      *isa = (enum bw_isa)k;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// core topology from /sys/devices/system/cpu, for pinning the generator's
+// threads. On big.LITTLE parts cores differ in cpu_capacity (1024 for the
+// biggest); kernels without it get a capacity scaled from the maximum
+// frequency instead. The cluster is topology/cluster_id, falling back to the
+// package and then to the frequency domain; the frequency domain is the
+// first CPU of cpufreq/related_cpus.
+
+#define MAX_CPUS 1024
+#define SYS_CPU "/sys/devices/system/cpu"
+
+struct cpu_info {
+  int cpu;
+  int cluster;
+  int capacity;
+  int freq_domain;
+  long max_khz;      // 0 if cpufreq is not exposed
+};
+
+// first integer in a sysfs file; returns 0, or -1 if absent
+static int read_sys_long(const char *path, long *value)
+{
+  FILE *fp = fopen(path, "r");
+  int ok;
+  if (fp == NULL) return -1;
+  ok = fscanf(fp, "%ld", value) == 1;
+  fclose(fp);
+  return ok ? 0 : -1;
+}
+
+// "0-3,6,8-9" into cpus[]; returns the count, or -1 if malformed
+static int parse_cpulist(const char *s, int *cpus, int max)
+{
+  int count = 0;
+  while (*s && *s != '\n') {
+    char *end;
+    long lo = strtol(s, &end, 10), hi = lo, c;
+    if (end == s || lo < 0) return -1;
+    s = end;
+    if (*s == '-') {
+      hi = strtol(s + 1, &end, 10);
+      if (end == s + 1 || hi < lo) return -1;
+      s = end;
+    }
+    for (c = lo; c <= hi; ++c) {
+      if (count == max) return -1;
+      cpus[count++] = (int)c;
+    }
+    if (*s == ',') ++s;
+    else if (*s && *s != '\n') return -1;
+  }
+  return count;
+}
+
+static int read_sys_cpulist(const char *path, int *cpus, int max)
+{
+  char line[4096];
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) return -1;
+  if (fgets(line, sizeof(line), fp) == NULL) line[0] = 0;
+  fclose(fp);
+  return parse_cpulist(line, cpus, max);
+}
+
+// the online CPUs in ascending order; returns the count, or -1
+static int discover_topology(struct cpu_info *info, int max)
+{
+  static int online[MAX_CPUS], related[MAX_CPUS];
+  char path[256];
+  long v, max_khz = 0;
+  int n, k, have_capacity = 1;
+
+  n = read_sys_cpulist(SYS_CPU "/online", online, MAX_CPUS);
+  if (n <= 0 || n > max) return -1;
+  for (k = 0; k < n; ++k) {
+    struct cpu_info *c = &info[k];
+    c->cpu = online[k];
+
+    snprintf(path, sizeof(path), SYS_CPU "/cpu%d/cpufreq/cpuinfo_max_freq", c->cpu);
+    c->max_khz = read_sys_long(path, &v) == 0 ? v : 0;
+    if (c->max_khz > max_khz) max_khz = c->max_khz;
+
+    snprintf(path, sizeof(path), SYS_CPU "/cpu%d/cpufreq/related_cpus", c->cpu);
+    c->freq_domain = read_sys_cpulist(path, related, MAX_CPUS) > 0 ? related[0] : c->cpu;
+
+    snprintf(path, sizeof(path), SYS_CPU "/cpu%d/cpu_capacity", c->cpu);
+    if (read_sys_long(path, &v) == 0) c->capacity = (int)v;
+    else have_capacity = 0;
+
+    snprintf(path, sizeof(path), SYS_CPU "/cpu%d/topology/cluster_id", c->cpu);
+    if (read_sys_long(path, &v) != 0 || v < 0) {
+      snprintf(path, sizeof(path), SYS_CPU "/cpu%d/topology/physical_package_id", c->cpu);
+      if (read_sys_long(path, &v) != 0 || v < 0) v = c->freq_domain;
+    }
+    c->cluster = (int)v;
+  }
+  if (!have_capacity)
+    for (k = 0; k < n; ++k)
+      info[k].capacity = max_khz > 0 ? (int)(info[k].max_khz * 1024 / max_khz) : 1024;
+  return n;
+}
+
+// the CPUs a policy selects, in the order threads are pinned to them:
+//   big, little  the cores of the highest / lowest capacity
+//   spread       every core, taking clusters in turn
+//   all          every core in order
+// anything else is read as a CPU list. returns the count, or -1
+static int select_cpus(const struct cpu_info *info, int n, const char *policy, int *out)
+{
+  int k, count = 0;
+  if (strcmp(policy, "big") == 0 || strcmp(policy, "little") == 0) {
+    int big = strcmp(policy, "big") == 0, want = info[0].capacity;
+    for (k = 1; k < n; ++k)
+      if (big ? info[k].capacity > want : info[k].capacity < want) want = info[k].capacity;
+    for (k = 0; k < n; ++k)
+      if (info[k].capacity == want) out[count++] = info[k].cpu;
+  } else if (strcmp(policy, "spread") == 0) {
+    // round r takes the r-th core of every cluster, clusters by first core
+    static int clusters[MAX_CPUS];
+    int nclusters = 0, round, c, j;
+    for (k = 0; k < n; ++k) {
+      for (j = 0; j < nclusters && clusters[j] != info[k].cluster; ++j) ;
+      if (j == nclusters) clusters[nclusters++] = info[k].cluster;
+    }
+    for (round = 0; count < n; ++round) {
+      for (c = 0; c < nclusters; ++c) {
+        int seen = 0;
+        for (k = 0; k < n; ++k) {
+          if (info[k].cluster != clusters[c]) continue;
+          if (seen++ == round) { out[count++] = info[k].cpu; break; }
+        }
+      }
+    }
+  } else if (strcmp(policy, "all") == 0) {
+    for (k = 0; k < n; ++k) out[count++] = info[k].cpu;
+  } else {
+    count = parse_cpulist(policy, out, MAX_CPUS);
+    for (k = 0; k < count; ++k) {
+      int j, found = 0;
+      for (j = 0; j < n; ++j) found |= info[j].cpu == out[k];
+      if (!found) {
+        fprintf(stderr, "cpu %d is not online\n", out[k]);
+        return -1;
+      }
+    }
+  }
+  return count > 0 ? count : -1;
+}
+
+static const struct cpu_info *find_cpu(const struct cpu_info *info, int n, int cpu)
+{
+  int k;
+  for (k = 0; k < n; ++k)
+    if (info[k].cpu == cpu) return &info[k];
+  return NULL;
+}
+
+// pin the calling thread to one CPU; returns 0, or -1
+static int pin_thread(int cpu)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "batch.h"
+#include "cache.h"
+#include "input.h"
+#include "parallel.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+int list_inputs(const char *path, vector<string> &inputs)
+{
+		error_code ec;
+		inputs.clear();
+		if (fs::is_directory(path, ec))
+		{
+				for (const auto &entry : fs::directory_iterator(path, ec))
+						if (entry.is_regular_file()) inputs.push_back(entry.path().string());
+				sort(inputs.begin(), inputs.end());
+				return 0;
+		}
+
+		ifstream manifest(path);
+		if (!manifest)
+		{
+				fprintf(stderr, "%s: not a directory or readable manifest\n", path);
+				return -1;
+		}
+		fs::path base = fs::path(path).parent_path();
+		string line;
+		while (getline(manifest, line))
+		{
+				size_t b = line.find_first_not_of(" \t\r");
+				if (b == string::npos || line[b] == '#') continue;
+				size_t e = line.find_last_not_of(" \t\r");
+				fs::path p = line.substr(b, e - b + 1);
+				inputs.push_back(p.is_absolute() ? p.string() : (base / p).string());
+		}
+		return 0;
+}
+
+void fit_batch(const vector<string> &inputs, vector<BatchResult> &results, unsigned threads)
+{
+		results.assign(inputs.size(), BatchResult());
+		parallel_for(inputs.size(), [&](size_t k, unsigned) {
+				BatchResult &r = results[k];
+				Sweep sweep;
+				r.input = inputs[k];
+				if (read_input(inputs[k].c_str(), sweep, nullptr, 1) != 0) { r.status = -1; return; }
+				r.status = fit_cached(sweep, r.model, default_cache_dir()) == 0 ? 0 : -2;
+		}, threads);
+}
+
+string table_field(const string &s)
+{
+		string out;
+		for (char c : s)
+		{
+				if (c == '%' || isspace((unsigned char)c))
+				{
+						char hex[4];
+						snprintf(hex, sizeof(hex), "%%%02X", (unsigned char)c);
+						out += hex;
+				}
+				else out += c;
+		}
+		return out.empty() ? "%00" : out;
+}
+
+void write_batch(FILE *fp, const vector<BatchResult> &results)
+{
+		fprintf(fp, "# input normal_BW intensive_BW MRMC TBWDC CBP rate_i status\n");
+		for (const BatchResult &r : results)
+		{
+				const PccsModel &m = r.model;
+				fprintf(fp, "%s %lf %lf %lf %lf %lf %lf %s\n", table_field(r.input).c_str(),
+				        m.normal_BW, m.intensive_BW, m.MRMC, m.TBWDC, m.CBP, m.rate_i,
+				        r.status == 0 ? "ok" : r.status == -1 ? "unreadable" : "no_boundary");
+		}
+}
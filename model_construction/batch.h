@@ -0,0 +1,33 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "pccs.h"
+
+struct BatchResult
+{
+		std::string input;
+		int status = -1;          // 0 fitted, -1 unreadable input, -2 no usable boundary
+		PccsModel model;
+};
+
+// expand a directory (every regular file, sorted) or a manifest (one input
+// path per line, '#' comments, relative to the manifest) into input paths;
+// returns -1 if the path is neither
+int list_inputs(const char *path, std::vector<std::string> &inputs);
+
+// read and fit every input on `threads` workers (0 = all cores);
+// results[k] belongs to inputs[k]
+void fit_batch(const std::vector<std::string> &inputs, std::vector<BatchResult> &results, unsigned threads = 0);
+
+// s as one field of a whitespace-separated table: whitespace and '%' are
+// written as %XX (hex), so a path with spaces stays one column
+std::string table_field(const std::string &s);
+
+// one row per input: name (as table_field), the six parameters, status
+void write_batch(FILE *fp, const std::vector<BatchResult> &results);
+
+#endif
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "corun.h"
+#include "input.h"
+#include "pccs.h"
+#include "predict_batch.h"
+
+using namespace std;
+
+// machine-readable results: one CSV row per (benchmark, size, phase), with
+// the best per-repetition time and the matching throughput
+#define CSV_HEADER "bench,n,m,phase,reps,seconds,rate\n"
+
+static double now()
+{
+		return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// best of `reps` timed calls
+template <class F>
+static double best_of(int reps, F fn)
+{
+		double best = 1e300;
+		for (int r = 0; r < reps; ++r)
+		{
+				double start = now();
+				fn();
+				best = min(best, now() - start);
+		}
+		return best;
+}
+
+// a compiler barrier on a timed result that is not read afterwards, so the
+// computation behind it cannot be dropped
+template <class T>
+static void keep(const T &value)
+{
+		__asm__ __volatile__("" : : "r"(&value) : "memory");
+}
+
+static void report(FILE *csv, const char *bench, long n, long m, const char *phase, int reps,
+                   double seconds, double items)
+{
+		fprintf(csv, "%s,%ld,%ld,%s,%d,%.9f,%.6g\n", bench, n, m, phase, reps, seconds, items / seconds);
+		fprintf(stderr, "  %-8s %6ld x %-6ld %-12s %12.6f s %14.4g /s\n", bench, n, m, phase, seconds, items / seconds);
+}
+
+// parameters fitted from input.txt
+static PccsModel sample_model()
+{
+		PccsModel model;
+		model.normal_BW = 37.6; model.intensive_BW = 65.7; model.MRMC = 3.723404;
+		model.TBWDC = 82.8; model.CBP = 46.633333; model.rate_i = 0.571106;
+		return model;
+}
+
+// a sweep shaped like a measured one: the kernels span 1..60 GB/s and the
+// external demand 1..80 GB/s, speeds follow a PCCS model with all three
+// regions (normal from 15 GB/s, intensive from 48 GB/s, contention from
+// 54 GB/s total demand, balance point at 40 GB/s) plus 0.3% measurement noise
+static void synthetic_sweep(int n, int m, unsigned seed, Sweep &sweep)
+{
+		PccsModel truth;
+		truth.normal_BW = 15; truth.intensive_BW = 48; truth.MRMC = 5;
+		truth.TBWDC = 54; truth.CBP = 40; truth.rate_i = 1.2;
+
+		mt19937_64 rng(seed);
+		normal_distribution<double> noise(0, 0.3);
+		sweep.standaloneBW.resize(n);
+		sweep.externalBW.resize(m);
+		for (int i = 0; i < n; ++i) sweep.standaloneBW[i] = 1 + 59.0 * i / max(n - 1, 1);
+		for (int j = 0; j < m; ++j) sweep.externalBW[j] = 1 + 79.0 * j / max(m - 1, 1);
+		sweep.achievedBW.resize(n, m);
+		for (int i = 0; i < n; ++i)
+				for (int j = 0; j < m; ++j)
+				{
+						double sa = sweep.standaloneBW[i];
+						double speed = predict_relative_speed(truth, sa, sweep.externalBW[j]) + noise(rng);
+						sweep.achievedBW[i][j] = sa * min(speed, 100.0) / 100;
+				}
+}
+
+static void bench_fit(FILE *csv, int max_size)
+{
+		string dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+		string path = dir + "/pccs_bench_" + to_string(getpid()) + ".txt";
+		for (int size = 10; size <= max_size; size *= 10)
+		{
+				long cells = (long)size * size;
+				int reps = (int)max(1L, min(1000L, 10000000L / cells));
+				Sweep sweep, parsed;
+				synthetic_sweep(size, size, 1, sweep);
+				if (write_input(path.c_str(), sweep) != 0) return;
+
+				ParseStats stats;
+				int read = 0;
+				double t = best_of(min(reps, 20), [&] { read = read_input(path.c_str(), parsed, &stats); });
+				remove(path.c_str());
+				if (read != 0) return;
+				report(csv, "fit", size, size, "parse", min(reps, 20), t, cells);
+
+				Matrix speed;
+				double PBW = 0;
+				t = best_of(reps, [&] { PBW = relative_speed(parsed, speed); });
+				report(csv, "fit", size, size, "speed", reps, t, cells);
+
+				Regions regions;
+				PccsModel model;
+				int status = 0;
+				t = best_of(reps, [&] { status = find_regions(parsed, speed, PBW, regions, model); });
+				report(csv, "fit", size, size, "regions", reps, t, cells);
+				if (status != 0 || !regions.minor) fprintf(stderr, "  synthetic %dx%d has no normal region\n", size, size);
+
+				FitWorkspace ws;
+				PccsModel fitted = model;
+				t = best_of(reps, [&] { fitted = model; fit_parameters(parsed, speed, regions, fitted, &ws); keep(fitted); });
+				report(csv, "fit", size, size, "parameters", reps, t, cells);
+		}
+}
+
+// single-thread throughput of every batch prediction kernel this CPU supports
+static void bench_predict(FILE *csv, size_t count, int reps)
+{
+		PccsModel model = sample_model();
+
+		mt19937_64 rng(1);
+		uniform_real_distribution<double> own_dist(0, 100), ext_dist(0, 130);
+		vector<double> own(count), ext(count), ref(count), out(count);
+		for (size_t k = 0; k < count; ++k) { own[k] = own_dist(rng); ext[k] = ext_dist(rng); }
+		predict_batch_kernel(ISA_SCALAR)(model, own.data(), ext.data(), ref.data(), count);
+
+		fprintf(stderr, "predict: dispatch selects %s\n", predict_isa_name(predict_batch_isa()));
+		for (int isa = 0; isa < ISA_COUNT; ++isa)
+		{
+				predict_batch_fn fn = predict_batch_kernel((PredictIsa)isa);
+				if (!fn) continue;
+				double t = best_of(reps, [&] { fn(model, own.data(), ext.data(), out.data(), count); });
+				if (memcmp(out.data(), ref.data(), count * sizeof(double)) != 0)
+						fprintf(stderr, "  %s MISMATCH vs scalar\n", predict_isa_name((PredictIsa)isa));
+				report(csv, "predict", count, 1, predict_isa_name((PredictIsa)isa), reps, t, count);
+		}
+}
+
+// fixed-point co-run solves of `pus` PUs with random workloads, as a
+// scheduler would issue them; rate is solves per second
+static void bench_corun(FILE *csv, int pus, int solves)
+{
+		PccsModel model = sample_model();
+
+		mt19937_64 rng(1);
+		uniform_real_distribution<double> bw(1, 60);
+		vector<CorunPu> sets((size_t)solves * pus);
+		for (CorunPu &p : sets) { p.model = model; p.standalone_bw = bw(rng); }
+
+		CorunResult result;
+		long iterations = 0;
+		int failed = 0;
+		double t = best_of(5, [&] {
+				iterations = 0; failed = 0;
+				for (int k = 0; k < solves; ++k)
+				{
+						failed += predict_corun(&sets[(size_t)k * pus], pus, result) != 0;
+						iterations += result.iterations;
+				}
+		});
+		fprintf(stderr, "corun: %d PUs, %.1f iterations per solve, %d not converged\n",
+		        pus, (double)iterations / solves, failed);
+		report(csv, "corun", pus, 1, "solve", 5, t / solves, 1);
+}
+
+typedef tuple<string, long, long, string> Key;
+
+// rows written by report() after CSV_HEADER; returns 0, or -1 (message on
+// stderr) when the file cannot be read or a line is not such a row
+static int load_csv(const char *path, map<Key, double> &rows)
+{
+		FILE *fp = fopen(path, "r");
+		if (fp == NULL) { fprintf(stderr, "%s: cannot open\n", path); return -1; }
+		char line[512], bench[64], phase[64];
+		long n, m;
+		int reps, used, lineno = 1, status = 0;
+		double seconds, rate;
+		if (fgets(line, sizeof(line), fp) == NULL || strcmp(line, CSV_HEADER) != 0)
+		{
+				fprintf(stderr, "%s: not a benchmark CSV\n", path);
+				status = -1;
+		}
+		while (status == 0 && fgets(line, sizeof(line), fp))
+		{
+				++lineno;
+				used = 0;
+				if (sscanf(line, "%63[^,],%ld,%ld,%63[^,],%d,%lf,%lf%n", bench, &n, &m, phase, &reps,
+				           &seconds, &rate, &used) != 7 || (line[used] != '\n' && line[used] != 0) || !(seconds >= 0))
+				{
+						fprintf(stderr, "%s:%d: malformed row\n", path, lineno);
+						status = -1;
+				}
+				else rows[Key(bench, n, m, phase)] = seconds;
+		}
+		fclose(fp);
+		return status;
+}
+
+// flag every row of `current` that is slower than `baseline` by more than
+// tolerance, and every baseline row that `current` lacks (a phase that was
+// dropped or crashed). returns 0, 1 for regressions or missing rows, 2 when
+// a file cannot be read
+static int compare(const char *baseline, const char *current, double tolerance)
+{
+		map<Key, double> base, cur;
+		if (load_csv(baseline, base) != 0 || load_csv(current, cur) != 0) return 2;
+		int regressions = 0, missing = 0;
+		for (auto &row : cur)
+		{
+				auto it = base.find(row.first);
+				if (it == base.end()) continue;
+				double ratio = row.second / it->second;
+				bool slow = ratio > 1 + tolerance;
+				regressions += slow;
+				printf("%-8s %6ld x %-6ld %-12s %8.3fx%s\n", get<0>(row.first).c_str(), get<1>(row.first),
+				       get<2>(row.first), get<3>(row.first).c_str(), ratio, slow ? "  REGRESSION" : "");
+		}
+		for (auto &row : base)
+				if (cur.find(row.first) == cur.end())
+				{
+						++missing;
+						printf("%-8s %6ld x %-6ld %-12s  MISSING\n", get<0>(row.first).c_str(), get<1>(row.first),
+						       get<2>(row.first), get<3>(row.first).c_str());
+				}
+		return regressions || missing ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+		if (argc > 1 && strcmp(argv[1], "compare") == 0)
+		{
+				if (argc < 4) { printf("./bench compare baseline.csv current.csv [tolerance]\n"); return 0; }
+				return compare(argv[2], argv[3], argc > 4 ? atof(argv[4]) : 0.10);
+		}
+		if (argc > 1 && strcmp(argv[1], "all") && strcmp(argv[1], "fit") && strcmp(argv[1], "predict")
+		    && strcmp(argv[1], "corun"))
+		{
+				printf("./bench [all|fit|predict|corun] [max_size] [csvfile]\n");
+				printf("./bench compare baseline.csv current.csv [tolerance]\n");
+				return 0;
+		}
+		string what = argc > 1 ? argv[1] : "all";
+		// 10000 is about 1.8 GB of temporary input and a few minutes; ask for it
+		int max_size = argc > 2 ? atoi(argv[2]) : 1000;
+		FILE *csv = argc > 3 ? fopen(argv[3], "w") : stdout;
+		if (csv == NULL) { fprintf(stderr, "%s: cannot open output file\n", argv[3]); return 1; }
+
+		fprintf(csv, CSV_HEADER);
+		if (what == "all" || what == "fit") bench_fit(csv, max_size);
+		if (what == "all" || what == "predict") bench_predict(csv, 1 << 20, 50);
+		if (what == "all" || what == "corun")
+				for (int pus = 2; pus <= 8; pus *= 2) bench_corun(csv, pus, 10000);
+		if (csv != stdout) fclose(csv);
+		return 0;
+}
@@ -0,0 +1,141 @@
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "bootstrap.h"
+#include "parallel.h"
+
+using namespace std;
+
+namespace {
+
+// splitmix64: tiny state, so every resample can own a generator
+struct SplitMix
+{
+		uint64_t x;
+		uint64_t next()
+		{
+				uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+				return z ^ (z >> 31);
+		}
+		// uniform in [0, n)
+		size_t below(size_t n) { return (size_t)(((unsigned __int128)next() * n) >> 64); }
+};
+
+void to_array(const PccsModel &m, double *p)
+{
+		p[0] = m.normal_BW; p[1] = m.intensive_BW; p[2] = m.MRMC;
+		p[3] = m.TBWDC; p[4] = m.CBP; p[5] = m.rate_i;
+}
+
+// q is clamped to [0, 1]
+double quantile(const vector<double> &sorted, double q)
+{
+		q = q > 0 ? min(q, 1.0) : 0;
+		double pos = q * (sorted.size() - 1);
+		size_t lo = (size_t)pos;
+		if (lo + 1 >= sorted.size()) return sorted.back();
+		return sorted[lo] + (sorted[lo+1] - sorted[lo]) * (pos - lo);
+}
+
+}
+
+int bootstrap(const Sweep &sweep, int iterations, double level, BootstrapResult &result,
+              unsigned threads, unsigned long long seed)
+{
+		int n = sweep.standaloneBW.size(), m = sweep.externalBW.size();
+		result = BootstrapResult();
+		result.level = level;
+		fill(result.low, result.low + 6, NAN);
+		fill(result.high, result.high + 6, NAN);
+
+		Matrix speed;
+		double PBW = relative_speed(sweep, speed);
+		int status = fit(sweep, speed, PBW, result.estimate);
+		if (status != 0 || iterations <= 0) return status;
+
+		vector<double> residuals;
+		for (int i = 0; i < n; ++i)
+				for (int j = 1; j + 1 < m; ++j)
+						residuals.push_back((speed[i][j] - (speed[i][j-1] + speed[i][j+1]) / 2) * sqrt(2.0 / 3));
+		// the sweep's real contention steps also show up as second differences;
+		// keep only residuals within 3 robust sigmas (1.4826 * MAD) as noise
+		if (!residuals.empty())
+		{
+				vector<double> dev(residuals);
+				size_t mid = dev.size() / 2;
+				nth_element(dev.begin(), dev.begin() + mid, dev.end());
+				double median = dev[mid];
+				for (double &d : dev) d = fabs(d - median);
+				nth_element(dev.begin(), dev.begin() + mid, dev.end());
+				double cut = 3 * 1.4826 * dev[mid];
+				residuals.erase(remove_if(residuals.begin(), residuals.end(),
+				                          [&](double r) { return fabs(r - median) > cut; }), residuals.end());
+		}
+		double mean = 0;
+		for (double r : residuals) mean += r;
+		if (!residuals.empty()) mean /= residuals.size();
+		for (double &r : residuals) r -= mean;
+		if (residuals.empty()) residuals.push_back(0);
+
+		if (threads == 0) threads = default_threads();
+		threads = min(threads, (unsigned)iterations);
+		vector<FitWorkspace> ws(threads);
+		for (FitWorkspace &w : ws)
+		{
+				w.speed.resize(n, m);
+				w.balancepoints.reserve(m+2);
+		}
+		vector<double> draws((size_t)iterations * 6, NAN);
+		vector<char> ok(iterations, 0);
+
+		parallel_for(iterations, [&](size_t k, unsigned worker) {
+				FitWorkspace &w = ws[worker];
+				SplitMix rng{seed * 0x2545f4914f6cdd1dULL + k};
+				double PBW_k = 0;
+				for (int i = 0; i < n; ++i)
+				{
+						const double *s = speed[i];
+						double *t = w.speed[i];
+						for (int j = 0; j < m; ++j)
+						{
+								t[j] = s[j] + residuals[rng.below(residuals.size())];
+								PBW_k = max(PBW_k, t[j] * sweep.standaloneBW[i] / 100);
+						}
+				}
+				PccsModel model;
+				if (fit(sweep, w.speed, PBW_k, model, &w) != 0) return;
+				ok[k] = 1;
+				to_array(model, &draws[k * 6]);
+		}, threads);
+
+		result.iterations = iterations;
+		for (int k = 0; k < iterations; ++k) result.fitted += ok[k];
+		vector<double> values;
+		values.reserve(iterations);
+		for (int p = 0; p < 6; ++p)
+		{
+				values.clear();
+				for (int k = 0; k < iterations; ++k)
+						if (ok[k] && isfinite(draws[k * 6 + p])) values.push_back(draws[k * 6 + p]);
+				if (values.empty()) continue;
+				sort(values.begin(), values.end());
+				result.low[p] = quantile(values, (1 - level) / 2);
+				result.high[p] = quantile(values, 1 - (1 - level) / 2);
+		}
+		return 0;
+}
+
+void write_bootstrap(FILE *fp, const BootstrapResult &result)
+{
+		static const char *names[6] = {"Normal BW", "intensive BW", "MRMC", "TBWDC", "CBP", "rate_i"};
+		double est[6];
+		to_array(result.estimate, est);
+		fprintf(fp, "# parameter estimate low high (%.0f%% percentile bootstrap, %d of %d resamples fitted)\n",
+		        result.level * 100, result.fitted, result.iterations);
+		for (int p = 0; p < 6; ++p)
+				fprintf(fp, "%s %lf %lf %lf\n", names[p], est[p], result.low[p], result.high[p]);
+}
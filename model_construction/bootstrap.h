@@ -0,0 +1,35 @@
+#ifndef BOOTSTRAP_H
+#define BOOTSTRAP_H
+
+#include <stdio.h>
+
+#include "pccs.h"
+
+// per-parameter percentile intervals, indexed like PccsModel's fields
+// (normal_BW, intensive_BW, MRMC, TBWDC, CBP, rate_i)
+struct BootstrapResult
+{
+		PccsModel estimate;        // fit of the measured sweep
+		double low[6], high[6];    // NaN when no resample produced the parameter
+		int iterations = 0;
+		int fitted = 0;            // resamples that fit (status 0)
+		double level = 0.95;
+};
+
+// residual bootstrap. Measurement noise is taken from the second difference
+// of relative speed along each kernel's row, e = (s[j] - (s[j-1]+s[j+1])/2)
+// * sqrt(2/3), which has the per-cell noise variance; residuals beyond 3
+// robust sigmas are real contention steps, not noise, and are dropped. Each
+// resample adds centred residuals drawn with replacement to the measured
+// speeds and refits. Resamples are spread over `threads` workers (0 = all cores), each
+// reusing one FitWorkspace; resample k draws from its own generator seeded
+// by (seed, k), so results do not depend on the thread count.
+// level is a fraction in (0, 1). returns the status of the measured fit
+// (resamples only when it is 0)
+int bootstrap(const Sweep &sweep, int iterations, double level, BootstrapResult &result,
+              unsigned threads = 0, unsigned long long seed = 1);
+
+// "name estimate low high" per parameter
+void write_bootstrap(FILE *fp, const BootstrapResult &result);
+
+#endif
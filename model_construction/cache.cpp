@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+
+#include "cache.h"
+
+using namespace std;
+
+// bump when the fitter's results change, so stale entries miss
+#define CACHE_VERSION 1
+
+static const uint64_t P1 = 0x9E3779B185EBCA87ULL, P2 = 0xC2B2AE3D27D4EB4FULL, P3 = 0x165667B19E3779F9ULL,
+                      P4 = 0x85EBCA77C2B2AE63ULL, P5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+static inline uint64_t load64(const unsigned char *p) { uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint32_t load32(const unsigned char *p) { uint32_t v; memcpy(&v, p, 4); return v; }
+static inline uint64_t round64(uint64_t acc, uint64_t input) { return rotl(acc + input * P2, 31) * P1; }
+static inline uint64_t merge64(uint64_t acc, uint64_t v) { return (acc ^ round64(0, v)) * P1 + P4; }
+
+Hash64::Hash64(uint64_t seed) : seed_(seed)
+{
+		acc_[0] = seed + P1 + P2;
+		acc_[1] = seed + P2;
+		acc_[2] = seed;
+		acc_[3] = seed - P1;
+}
+
+void Hash64::update(const void *data, size_t len)
+{
+		const unsigned char *p = (const unsigned char *)data, *end = p + len;
+		total_ += len;
+		if (buffered_ + len < 32)
+		{
+				memcpy(buf_ + buffered_, p, len);
+				buffered_ += len;
+				return;
+		}
+		if (buffered_)
+		{
+				size_t take = 32 - buffered_;
+				memcpy(buf_ + buffered_, p, take);
+				p += take;
+				for (int k = 0; k < 4; ++k) acc_[k] = round64(acc_[k], load64(buf_ + 8 * k));
+				buffered_ = 0;
+		}
+		for (; p + 32 <= end; p += 32)
+		{
+				acc_[0] = round64(acc_[0], load64(p));
+				acc_[1] = round64(acc_[1], load64(p + 8));
+				acc_[2] = round64(acc_[2], load64(p + 16));
+				acc_[3] = round64(acc_[3], load64(p + 24));
+		}
+		memcpy(buf_, p, end - p);
+		buffered_ = end - p;
+}
+
+uint64_t Hash64::digest() const
+{
+		uint64_t h;
+		if (total_ >= 32)
+		{
+				h = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+				for (int k = 0; k < 4; ++k) h = merge64(h, acc_[k]);
+		}
+		else h = seed_ + P5;
+		h += total_;
+
+		const unsigned char *p = buf_, *end = buf_ + buffered_;
+		for (; p + 8 <= end; p += 8) h = rotl(h ^ round64(0, load64(p)), 27) * P1 + P4;
+		if (p + 4 <= end) { h = rotl(h ^ (load32(p) * P1), 23) * P2 + P3; p += 4; }
+		for (; p < end; ++p) h = rotl(h ^ (*p * P5), 11) * P1;
+
+		h ^= h >> 33; h *= P2;
+		h ^= h >> 29; h *= P3;
+		h ^= h >> 32;
+		return h;
+}
+
+string model_cache_key(const Sweep &sweep, const FitThresholds &thresholds)
+{
+		Hash64 h(CACHE_VERSION);
+		uint64_t dims[2] = {sweep.standaloneBW.size(), sweep.externalBW.size()};
+		h.update(dims, sizeof dims);
+		h.update(sweep.standaloneBW.data(), dims[0] * sizeof(double));
+		h.update(sweep.externalBW.data(), dims[1] * sizeof(double));
+		// rows only: the padding past column m is not data
+		for (size_t i = 0; i < dims[0]; ++i) h.update(sweep.achievedBW[i], dims[1] * sizeof(double));
+		double t[3] = {thresholds.minor, thresholds.normal_factor, thresholds.balance_factor};
+		h.update(t, sizeof t);
+		char hex[17];
+		snprintf(hex, sizeof hex, "%016llx", (unsigned long long)h.digest());
+		return hex;
+}
+
+static string entry_path(const char *dir, const string &key)
+{
+		return string(dir) + "/" + key + ".model";
+}
+
+int cache_lookup(const char *dir, const string &key, const Sweep &sweep, PccsModel &model, int &status)
+{
+		FILE *fp = fopen(entry_path(dir, key).c_str(), "r");
+		if (fp == NULL) return -1;
+		PccsModel m;
+		int n = -1, cols = -1, st = 0;
+		bool ok = read_model(fp, m) == 0 && fscanf(fp, " size %d %d status %d", &n, &cols, &st) == 3;
+		fclose(fp);
+		// a hash collision would almost surely differ in size
+		if (!ok || n != (int)sweep.standaloneBW.size() || cols != (int)sweep.externalBW.size()) return -1;
+		model = m;
+		status = st;
+		return 0;
+}
+
+int cache_store(const char *dir, const string &key, const Sweep &sweep, const PccsModel &model, int status)
+{
+		static atomic<unsigned> serial(0);
+		string path = entry_path(dir, key);
+		string tmp = path + ".tmp." + to_string(getpid()) + "." + to_string(serial++);
+		FILE *fp = fopen(tmp.c_str(), "w");
+		if (fp == NULL) { fprintf(stderr, "%s: cannot write cache entry\n", tmp.c_str()); return -1; }
+		// full precision, so a hit returns the fitted values bit for bit
+		fprintf(fp, "Normal BW %.17g\nintensive BW %.17g\nMRMC %.17g\nTBWDC %.17g\nCBP %.17g\nrate_i %.17g\n",
+		        model.normal_BW, model.intensive_BW, model.MRMC, model.TBWDC, model.CBP, model.rate_i);
+		fprintf(fp, "size %d %d\nstatus %d\n", (int)sweep.standaloneBW.size(), (int)sweep.externalBW.size(), status);
+		bool ok = fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+		ok = fclose(fp) == 0 && ok;
+		if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+		{
+				fprintf(stderr, "%s: cannot write cache entry\n", path.c_str());
+				remove(tmp.c_str());
+				return -1;
+		}
+		return 0;
+}
+
+int fit_cached(const Sweep &sweep, PccsModel &model, const char *dir, bool *hit, const FitThresholds &thresholds)
+{
+		if (hit) *hit = false;
+		if (dir == NULL || *dir == 0)
+		{
+				Matrix speed;
+				double PBW = relative_speed(sweep, speed);
+				return fit(sweep, speed, PBW, model, nullptr, thresholds);
+		}
+		string key = model_cache_key(sweep, thresholds);
+		int status;
+		if (cache_lookup(dir, key, sweep, model, status) == 0)
+		{
+				if (hit) *hit = true;
+				return status;
+		}
+		Matrix speed;
+		double PBW = relative_speed(sweep, speed);
+		status = fit(sweep, speed, PBW, model, nullptr, thresholds);
+		cache_store(dir, key, sweep, model, status);
+		return status;
+}
+
+const char *default_cache_dir()
+{
+		const char *dir = getenv("PCCS_CACHE");
+		return dir && *dir ? dir : NULL;
+}
@@ -0,0 +1,47 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "pccs.h"
+
+// streaming XXH64
+class Hash64
+{
+public:
+		explicit Hash64(uint64_t seed = 0);
+		void update(const void *data, size_t len);
+		uint64_t digest() const;
+
+private:
+		uint64_t acc_[4];
+		unsigned char buf_[32];
+		size_t buffered_ = 0;
+		uint64_t total_ = 0, seed_;
+};
+
+// hex key of everything a fit depends on: the sweep's dimensions and values
+// and the thresholds, seeded with the cache format version
+std::string model_cache_key(const Sweep &sweep, const FitThresholds &thresholds = FitThresholds());
+
+// one file per key in `dir`: the six-line model text, then its dimensions
+// and fit status. Entries are written to a private temporary file and
+// renamed into place, so any number of processes can share a directory and
+// a reader only ever sees complete entries.
+// returns 0 on a hit, -1 on a miss
+int cache_lookup(const char *dir, const std::string &key, const Sweep &sweep, PccsModel &model, int &status);
+// returns 0, or -1 (message on stderr)
+int cache_store(const char *dir, const std::string &key, const Sweep &sweep, const PccsModel &model, int status);
+
+// fit() through the cache in `dir` (no cache when dir is null or empty);
+// hit, if given, says whether the fit was skipped. Cache errors are reported
+// and otherwise ignored. returns the fit status
+int fit_cached(const Sweep &sweep, PccsModel &model, const char *dir, bool *hit = nullptr,
+               const FitThresholds &thresholds = FitThresholds());
+
+// the cache directory named by $PCCS_CACHE, or null
+const char *default_cache_dir();
+
+#endif
@@ -0,0 +1,64 @@
+#include <math.h>
+#include <algorithm>
+
+#include "corun.h"
+
+using namespace std;
+
+// one Jacobi sweep: the relative speeds and achieved BWs the PUs would reach
+// if the others kept achieving x
+static void evaluate(const CorunPu *pus, size_t count, const vector<double> &x, CorunResult &result)
+{
+		double total = 0;
+		for (size_t k = 0; k < count; ++k) total += x[k];
+		for (size_t k = 0; k < count; ++k)
+		{
+				double ext = max(total - x[k], 0.0);
+				double rs = predict_relative_speed(pus[k].model, pus[k].standalone_bw, ext);
+				result.external_bw[k] = ext;
+				result.relative_speed[k] = rs;
+				result.slowdown[k] = 100 / rs;
+				result.achieved_bw[k] = pus[k].standalone_bw * rs / 100;
+		}
+}
+
+int predict_corun(const CorunPu *pus, size_t count, CorunResult &result, const CorunOptions &options)
+{
+		result.achieved_bw.resize(count);
+		result.external_bw.resize(count);
+		result.relative_speed.resize(count);
+		result.slowdown.resize(count);
+		result.iterations = 0;
+		result.residual = 0;
+
+		// x is the current iterate, d the previous update direction;
+		// evaluate() leaves f(x) in result.achieved_bw
+		static thread_local vector<double> x, d;
+		x.resize(count);
+		d.assign(count, 0);
+		for (size_t k = 0; k < count; ++k) x[k] = pus[k].standalone_bw;
+
+		double alpha = options.damping, last = INFINITY;
+		for (int it = 1; it <= options.max_iterations; ++it)
+		{
+				evaluate(pus, count, x, result);
+				double step = 0, turn = 0;
+				for (size_t k = 0; k < count; ++k)
+				{
+						double dk = result.achieved_bw[k] - x[k];
+						step = max(step, fabs(dk));
+						turn += dk * d[k];
+						d[k] = dk;
+				}
+				result.iterations = it;
+				result.residual = step;
+				if (step <= options.tolerance) return 0;
+				// overshooting: the step grew, or it reversed direction without
+				// at least halving; a step that halves lets the damping relax again
+				if (step >= last || (turn < 0 && step > last / 2)) alpha = max(alpha / 2, 1.0 / 64);
+				else if (step < last / 2) alpha = min(alpha * 1.5, options.damping);
+				last = step;
+				for (size_t k = 0; k < count; ++k) x[k] += alpha * d[k];
+		}
+		return -1;
+}
@@ -0,0 +1,51 @@
+#ifndef CORUN_H
+#define CORUN_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "pccs.h"
+
+// one PU in a co-run: its fitted model and the BW its current workload
+// achieves when running alone
+struct CorunPu
+{
+		PccsModel model;
+		double standalone_bw = 0;
+};
+
+struct CorunOptions
+{
+		double tolerance = 1e-6;       // GB/s; stop when no achieved BW moves more than this
+		int max_iterations = 1000;
+		double damping = 1.0;          // weight of the new iterate; halved whenever a step does not shrink
+};
+
+// per-PU results, indexed like the input
+struct CorunResult
+{
+		std::vector<double> achieved_bw;      // standalone_bw * relative_speed / 100
+		std::vector<double> external_bw;      // sum of the other PUs' achieved BW
+		std::vector<double> relative_speed;   // percent
+		std::vector<double> slowdown;         // 100 / relative_speed
+		int iterations = 0;
+		double residual = 0;                  // largest change in the last iteration
+};
+
+// predict every PU's speed while all of them run together. Each PU's
+// external demand is what the others actually achieve, which in turn depends
+// on how much they are slowed down, so the achieved BWs are solved as the
+// fixed point x[k] = standalone[k] * predict_relative_speed(model[k],
+// standalone[k], sum of x[j], j != k) / 100, starting from the standalone BWs.
+// The map is decreasing in the other PUs' BW, so plain iteration can
+// oscillate; the step is damped while it overshoots. A solution is unique
+// and found when no PU loses as much achieved BW as the others gain
+// (standalone_bw * rate_i / 100 < 1); most solves take a handful of steps.
+// result's vectors are reused, so a caller that keeps one CorunResult does
+// not allocate after the first call.
+// returns 0 when converged, or -1 after max_iterations (result holds the
+// last iterate)
+int predict_corun(const CorunPu *pus, size_t count, CorunResult &result,
+                  const CorunOptions &options = CorunOptions());
+
+#endif
@@ -0,0 +1,242 @@
+#include <string>
+
+#include "diagnostics.h"
+#include "writer.h"
+
+using namespace std;
+
+namespace {
+
+// the two output formats, driven through the schema by emit()
+class Emitter
+{
+public:
+		virtual ~Emitter() {}
+		virtual void begin(const char *key) = 0;
+		virtual void end() = 0;
+		virtual void text(const char *key, const char *value) = 0;
+		virtual void flag(const char *key, bool value) = 0;
+		virtual void integer(const char *key, long value) = 0;
+		virtual void number(const char *key, double value) = 0;
+		virtual void integers(const char *key, const int *values, size_t count) = 0;
+		virtual void numbers(const char *key, const double *values, size_t count) = 0;
+		virtual void matrix(const char *key, const Matrix &values) = 0;
+};
+
+void put_json_string(BufferedWriter &out, const char *s)
+{
+		out.put('"');
+		for (; *s; ++s)
+		{
+				unsigned char c = *s;
+				if (c == '"' || c == '\\') { out.put('\\'); out.put((char)c); }
+				else if (c < 0x20)
+				{
+						static const char hex[] = "0123456789abcdef";
+						char esc[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+						out.put(esc, sizeof(esc));
+				}
+				else out.put((char)c);
+		}
+		out.put('"');
+}
+
+class JsonEmitter : public Emitter
+{
+public:
+		JsonEmitter(BufferedWriter &out) : out_(out) { out_.put('{'); }
+		~JsonEmitter() { out_.put("\n}\n"); }
+
+		void begin(const char *key) { open(key); out_.put('{'); first_ = true; ++depth_; }
+		void end() { --depth_; newline(); out_.put('}'); first_ = false; }
+		void text(const char *key, const char *value) { open(key); put_json_string(out_, value); }
+		void flag(const char *key, bool value) { open(key); out_.put(value ? "true" : "false"); }
+		void integer(const char *key, long value) { open(key); out_.put(value); }
+		void number(const char *key, double value) { open(key); out_.put(value); }
+		void integers(const char *key, const int *values, size_t count)
+		{
+				open(key);
+				out_.put('[');
+				for (size_t k = 0; k < count; ++k) { if (k) out_.put(','); out_.put((long)values[k]); }
+				out_.put(']');
+		}
+		void numbers(const char *key, const double *values, size_t count)
+		{
+				open(key);
+				row(values, count);
+		}
+		void matrix(const char *key, const Matrix &values)
+		{
+				open(key);
+				out_.put('[');
+				for (int i = 0; i < values.rows(); ++i)
+				{
+						out_.put(i ? ",\n" : "\n");
+						for (int d = 0; d <= depth_; ++d) out_.put('\t');
+						row(values[i], values.cols());
+				}
+				newline();
+				out_.put(']');
+		}
+
+private:
+		void newline()
+		{
+				out_.put('\n');
+				for (int d = 0; d < depth_; ++d) out_.put('\t');
+		}
+		void open(const char *key)
+		{
+				if (!first_) out_.put(',');
+				first_ = false;
+				newline();
+				put_json_string(out_, key);
+				out_.put(": ");
+		}
+		void row(const double *values, size_t count)
+		{
+				out_.put('[');
+				for (size_t k = 0; k < count; ++k) { if (k) out_.put(','); out_.put(values[k]); }
+				out_.put(']');
+		}
+
+		BufferedWriter &out_;
+		bool first_ = true;
+		int depth_ = 1;
+};
+
+class CsvEmitter : public Emitter
+{
+public:
+		CsvEmitter(BufferedWriter &out) : out_(out) { out_.put("quantity,i,j,value\n"); }
+
+		void begin(const char *key) { prefix_.push_back(prefix_.empty() ? key : prefix_.back() + "." + key); }
+		void end() { prefix_.pop_back(); }
+		void text(const char *key, const char *value)
+		{
+				name(key);
+				out_.put(",,,\"");
+				for (const char *s = value; *s; ++s) { if (*s == '"') out_.put('"'); out_.put(*s); }
+				out_.put("\"\n");
+		}
+		void flag(const char *key, bool value) { integer(key, value); }
+		void integer(const char *key, long value) { name(key); out_.put(",,,"); out_.put(value); out_.put('\n'); }
+		void number(const char *key, double value) { name(key); out_.put(",,,"); out_.put(value); out_.put('\n'); }
+		void integers(const char *key, const int *values, size_t count)
+		{
+				for (size_t k = 0; k < count; ++k)
+				{
+						name(key); out_.put(','); out_.put((long)k); out_.put(",,"); out_.put((long)values[k]); out_.put('\n');
+				}
+		}
+		void numbers(const char *key, const double *values, size_t count)
+		{
+				for (size_t k = 0; k < count; ++k)
+				{
+						name(key); out_.put(','); out_.put((long)k); out_.put(",,"); out_.put(values[k]); out_.put('\n');
+				}
+		}
+		void matrix(const char *key, const Matrix &values)
+		{
+				for (int i = 0; i < values.rows(); ++i)
+						for (int j = 0; j < values.cols(); ++j)
+						{
+								name(key); out_.put(','); out_.put((long)i); out_.put(','); out_.put((long)j);
+								out_.put(','); out_.put(values[i][j]); out_.put('\n');
+						}
+		}
+
+private:
+		void name(const char *key)
+		{
+				if (!prefix_.empty()) { out_.put(prefix_.back()); out_.put('.'); }
+				out_.put(key);
+		}
+
+		BufferedWriter &out_;
+		vector<string> prefix_;
+};
+
+void emit(Emitter &e, const char *input, const Sweep &sweep, const FitDiagnostics &d)
+{
+		const PccsModel &model = d.model;
+		const Regions &regions = d.regions;
+		const FitWorkspace &ws = d.ws;
+		e.text("schema", "pccs-diagnostics");
+		e.integer("version", 1);
+		e.text("input", input);
+		e.text("status", d.status == 0 ? "ok" : "no_boundary");
+		e.integer("n", sweep.standaloneBW.size());
+		e.integer("m", sweep.externalBW.size());
+		e.number("peak_bw", d.peak_bw);
+
+		e.begin("thresholds");
+		e.number("minor", regions.thresholds.minor);
+		e.number("normal_factor", regions.thresholds.normal_factor);
+		e.number("balance_factor", regions.thresholds.balance_factor);
+		e.end();
+
+		e.begin("model");
+		e.number("normal_BW", model.normal_BW);
+		e.number("intensive_BW", model.intensive_BW);
+		e.number("MRMC", model.MRMC);
+		e.number("TBWDC", model.TBWDC);
+		e.number("CBP", model.CBP);
+		e.number("rate_i", model.rate_i);
+		e.end();
+
+		e.begin("regions");
+		e.flag("minor", regions.minor);
+		e.number("reduction", regions.reduction);
+		e.integer("normal_boundary", regions.normal_boundary);
+		e.integer("intensive_boundary", regions.intensive_boundary);
+		e.end();
+
+		e.numbers("standalone_bw", sweep.standaloneBW.data(), sweep.standaloneBW.size());
+		e.numbers("external_bw", sweep.externalBW.data(), sweep.externalBW.size());
+		e.integers("balance_histogram", ws.balancepoints.data(), ws.balancepoints.size());
+
+		vector<int> kernels;
+		for (size_t r = 0; r < ws.onset_column.size(); ++r) kernels.push_back(regions.normal_boundary + r);
+		e.begin("normal_kernels");
+		e.integers("kernel", kernels.data(), kernels.size());
+		e.integers("onset_column", ws.onset_column.data(), ws.onset_column.size());
+		e.numbers("onset_demand", ws.onset_demand.data(), ws.onset_demand.size());
+		e.integers("balance_column", ws.balance_column.data(), ws.balance_column.size());
+		e.end();
+
+		e.matrix("relative_speed", ws.speed);
+}
+
+}
+
+int diagnose_fit(const Sweep &sweep, FitDiagnostics &diag, const FitThresholds &thresholds)
+{
+		diag.peak_bw = relative_speed(sweep, diag.ws.speed);
+		diag.ws.balancepoints.clear();
+		diag.ws.onset_column.clear();
+		diag.ws.onset_demand.clear();
+		diag.ws.balance_column.clear();
+		diag.status = find_regions(sweep, diag.ws.speed, diag.peak_bw, diag.regions, diag.model, thresholds);
+		if (diag.status == 0) fit_parameters(sweep, diag.ws.speed, diag.regions, diag.model, &diag.ws);
+		return diag.status;
+}
+
+int write_diagnostics(const char *path, DiagnosticsFormat format, const char *input, const Sweep &sweep,
+                      const FitDiagnostics &diag)
+{
+		BufferedWriter out;
+		if (format == DIAG_JSON)
+		{
+				if (out.open(path, "null") != 0) return -1;
+				JsonEmitter e(out);
+				emit(e, input, sweep, diag);
+		}
+		else
+		{
+				if (out.open(path, "nan") != 0) return -1;
+				CsvEmitter e(out);
+				emit(e, input, sweep, diag);
+		}
+		return out.close();
+}
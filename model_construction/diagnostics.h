@@ -0,0 +1,38 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include "pccs.h"
+
+// everything a fit computes on the way to the six parameters.
+// ws.speed is the relative speed matrix; the per-kernel vectors of ws cover
+// the normal kernels, rows regions.normal_boundary .. intensive_boundary - 1
+struct FitDiagnostics
+{
+		int status = -1;               // fit()'s return value
+		double peak_bw = 0;
+		Regions regions;
+		PccsModel model;
+		FitWorkspace ws;
+};
+
+int diagnose_fit(const Sweep &sweep, FitDiagnostics &diag, const FitThresholds &thresholds = FitThresholds());
+
+enum DiagnosticsFormat { DIAG_JSON, DIAG_CSV };
+
+// schema "pccs-diagnostics" version 1, written through a BufferedWriter.
+// JSON is one object whose keys are, in order: schema, version, input,
+// status, n, m, peak_bw, thresholds{minor, normal_factor, balance_factor},
+// model{normal_BW, intensive_BW, MRMC, TBWDC, CBP, rate_i},
+// regions{minor, reduction, normal_boundary, intensive_boundary},
+// standalone_bw[n], external_bw[m], balance_histogram[m+2],
+// normal_kernels{kernel, onset_column, onset_demand, balance_column} (equal
+// length arrays) and relative_speed[n][m]; non-finite numbers are null.
+// CSV is "quantity,i,j,value" with one row per scalar, array element or
+// matrix cell, nested keys joined by '.' (thresholds.minor, normal_kernels.kernel),
+// i and j empty where they do not apply. CBP is the sum of
+// balance_histogram[k] * external_bw[k] over 1 <= k < m, divided by the
+// number of normal kernels + 1. returns 0, or -1 (message on stderr)
+int write_diagnostics(const char *path, DiagnosticsFormat format, const char *input, const Sweep &sweep,
+                      const FitDiagnostics &diag);
+
+#endif
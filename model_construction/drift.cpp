@@ -0,0 +1,234 @@
+#include <math.h>
+#include <algorithm>
+#include <random>
+
+#include "batch.h"
+#include "drift.h"
+#include "input.h"
+#include "parallel.h"
+
+using namespace std;
+
+namespace {
+
+// one quantity tracked across runs: dim values per run, row-major
+struct Series
+{
+		const char *name;
+		int dim;
+		vector<size_t> run;            // runs[] index of each row
+		vector<double> x;
+};
+
+struct Split
+{
+		size_t k;                      // first row after the shift
+		double p_value;
+};
+
+// best split of rows into [0, k) and [k, L): the k maximizing
+// k (L - k) / L * |mean_left - mean_right|^2, at least min_segment from each end;
+// best stays 0 and the result is -1 when no k qualifies
+double best_split(const vector<const double *> &rows, int dim, int min_segment, const vector<double> &total,
+                  vector<double> &left, size_t &best)
+{
+		size_t L = rows.size();
+		left.assign(dim, 0);
+		double best_stat = -1;
+		best = 0;
+		for (size_t k = 1; k + min_segment <= L; ++k)
+		{
+				const double *r = rows[k-1];
+				for (int d = 0; d < dim; ++d) left[d] += r[d];
+				if (k < (size_t)min_segment) continue;
+				double stat = 0;
+				for (int d = 0; d < dim; ++d)
+				{
+						double diff = left[d] / k - (total[d] - left[d]) / (L - k);
+						stat += diff * diff;
+				}
+				stat *= (double)k * (L - k) / L;
+				if (stat > best_stat) { best_stat = stat; best = k; }
+		}
+		return best_stat;
+}
+
+// binary segmentation of rows [a, b) of a series
+void segment(const Series &s, size_t a, size_t b, const DriftOptions &options, mt19937_64 &rng,
+             vector<Split> &splits)
+{
+		size_t L = b - a;
+		if (L < 2 * (size_t)options.min_segment) return;
+		int dim = s.dim;
+		vector<const double *> rows(L);
+		vector<double> total(dim, 0), left;
+		for (size_t r = 0; r < L; ++r)
+		{
+				rows[r] = &s.x[(a + r) * dim];
+				for (int d = 0; d < dim; ++d) total[d] += rows[r][d];
+		}
+		size_t k = 0, unused;
+		double observed = best_split(rows, dim, options.min_segment, total, left, k);
+		// no split, or none that separates anything
+		if (k == 0 || !(observed > 0)) return;
+
+		// permutation test: how often does a shuffled series split as well?
+		// stops as soon as the split can no longer be significant
+		int exceed = 0, done = 0;
+		for (; done < options.permutations; ++done)
+		{
+				if ((exceed + 1.0) / (options.permutations + 1.0) > options.alpha) break;
+				shuffle(rows.begin(), rows.end(), rng);
+				if (best_split(rows, dim, options.min_segment, total, left, unused) >= observed * (1 - 1e-12))
+						++exceed;
+		}
+		if (done < options.permutations) return;
+		Split split = {a + k, (exceed + 1.0) / (options.permutations + 1.0)};
+		splits.push_back(split);
+		segment(s, a, a + k, options, rng, splits);
+		segment(s, a + k, b, options, rng, splits);
+}
+
+void segment_mean(const Series &s, size_t a, size_t b, vector<double> &mean)
+{
+		mean.assign(s.dim, 0);
+		for (size_t r = a; r < b; ++r)
+				for (int d = 0; d < s.dim; ++d) mean[d] += s.x[r * s.dim + d];
+		for (double &v : mean) v /= b - a;
+}
+
+void summarize(const Sweep &sweep, int bins, DriftRun &run)
+{
+		Matrix speed;
+		relative_speed(sweep, speed);
+		int n = run.n, m = run.m;
+		int br = min(bins, n), bc = min(bins, m);
+		run.surface.assign((size_t)br * bc, 0);
+		vector<int> count((size_t)br * bc, 0);
+		double sum = 0;
+		for (int i = 0; i < n; ++i)
+				for (int j = 0; j < m; ++j)
+				{
+						size_t c = (size_t)(i * br / n) * bc + j * bc / m;
+						run.surface[c] += speed[i][j];
+						++count[c];
+						sum += speed[i][j];
+				}
+		for (size_t c = 0; c < run.surface.size(); ++c) run.surface[c] /= count[c];
+		run.mean_speed = sum / ((double)n * m);
+}
+
+}
+
+void detect_drift(const vector<string> &inputs, vector<DriftRun> &runs, vector<ChangePoint> &changes,
+                  const DriftOptions &options, unsigned threads)
+{
+		runs.assign(inputs.size(), DriftRun());
+		changes.clear();
+		parallel_for(inputs.size(), [&](size_t k, unsigned) {
+				DriftRun &r = runs[k];
+				Sweep sweep;
+				r.input = inputs[k];
+				if (read_input(inputs[k].c_str(), sweep, nullptr, 1) != 0) return;
+				r.n = sweep.standaloneBW.size();
+				r.m = sweep.externalBW.size();
+				summarize(sweep, options.bins, r);
+				r.status = fit(sweep, r.model) == 0 ? 0 : -2;
+		}, threads);
+
+		const DriftRun *first = nullptr;
+		for (DriftRun &r : runs)
+		{
+				if (r.status == -1) continue;
+				if (first == nullptr) first = &r;
+				r.on_grid = r.n == first->n && r.m == first->m;
+		}
+
+		static const char *names[] = {"normal_BW", "intensive_BW", "MRMC", "TBWDC", "CBP", "rate_i"};
+		vector<Series> series;
+		for (int p = 0; p < 6; ++p)
+		{
+				Series s = {names[p], 1, {}, {}};
+				for (size_t k = 0; k < runs.size(); ++k)
+				{
+						if (runs[k].status != 0) continue;
+						const PccsModel &m = runs[k].model;
+						const double values[6] = {m.normal_BW, m.intensive_BW, m.MRMC, m.TBWDC, m.CBP, m.rate_i};
+						// e.g. TBWDC and rate_i of a fit without normal kernels
+						if (!isfinite(values[p])) continue;
+						s.run.push_back(k);
+						s.x.push_back(values[p]);
+				}
+				series.push_back(s);
+		}
+		if (first)
+		{
+				Series s = {"surface", (int)first->surface.size(), {}, {}};
+				for (size_t k = 0; k < runs.size(); ++k)
+				{
+						if (!runs[k].on_grid) continue;
+						bool finite = true;
+						for (double v : runs[k].surface) finite = finite && isfinite(v);
+						if (!finite) continue;
+						s.run.push_back(k);
+						s.x.insert(s.x.end(), runs[k].surface.begin(), runs[k].surface.end());
+				}
+				series.push_back(s);
+		}
+
+		mt19937_64 rng(options.seed);
+		for (const Series &s : series)
+		{
+				vector<Split> splits;
+				segment(s, 0, s.run.size(), options, rng, splits);
+				sort(splits.begin(), splits.end(), [](const Split &a, const Split &b) { return a.k < b.k; });
+				vector<double> before, after;
+				for (size_t i = 0; i < splits.size(); ++i)
+				{
+						// compare with the neighbouring segments, not the whole series
+						size_t a = i ? splits[i-1].k : 0;
+						size_t b = i + 1 < splits.size() ? splits[i+1].k : s.run.size();
+						segment_mean(s, a, splits[i].k, before);
+						segment_mean(s, splits[i].k, b, after);
+						ChangePoint c = {s.name, s.run[splits[i].k - 1], splits[i].p_value, 0, 0, 0};
+						if (s.dim == 1)
+						{
+								c.before = before[0];
+								c.after_value = after[0];
+								c.shift = after[0] - before[0];
+						}
+						else
+						{
+								double sq = 0;
+								for (int d = 0; d < s.dim; ++d)
+								{
+										c.before += before[d] / s.dim;
+										c.after_value += after[d] / s.dim;
+										sq += (after[d] - before[d]) * (after[d] - before[d]);
+								}
+								c.shift = sqrt(sq / s.dim);
+						}
+						changes.push_back(c);
+				}
+		}
+}
+
+void write_drift(FILE *fp, const vector<DriftRun> &runs, const vector<ChangePoint> &changes,
+                 const DriftOptions &options)
+{
+		fprintf(fp, "# run input normal_BW intensive_BW MRMC TBWDC CBP rate_i mean_speed status\n");
+		for (size_t k = 0; k < runs.size(); ++k)
+		{
+				const DriftRun &r = runs[k];
+				const PccsModel &m = r.model;
+				fprintf(fp, "%zu %s %lf %lf %lf %lf %lf %lf %lf %s\n", k, table_field(r.input).c_str(),
+				        m.normal_BW, m.intensive_BW, m.MRMC, m.TBWDC, m.CBP, m.rate_i, r.mean_speed,
+				        r.status == -1 ? "unreadable" : r.status == -2 ? "no_boundary" :
+				        r.on_grid ? "ok" : "off_grid");
+		}
+		fprintf(fp, "# series after_run p_value before after shift (alpha %g, %d permutations)\n",
+		        options.alpha, options.permutations);
+		for (const ChangePoint &c : changes)
+				fprintf(fp, "%s %zu %lf %lf %lf %lf\n", c.series.c_str(), c.after, c.p_value,
+				        c.before, c.after_value, c.shift);
+}
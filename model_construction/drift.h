@@ -0,0 +1,59 @@
+#ifndef DRIFT_H
+#define DRIFT_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "pccs.h"
+
+struct DriftOptions
+{
+		double alpha = 0.01;           // a split is reported when its p-value is at most this
+		int permutations = 999;        // permutation test size
+		int min_segment = 3;           // runs on either side of a split
+		int bins = 8;                  // surface summary is up to bins x bins cells
+		unsigned long long seed = 1;
+};
+
+// what is kept of one run once its sweep has been fitted and dropped
+struct DriftRun
+{
+		std::string input;
+		int status = -1;               // 0 fitted, -1 unreadable input, -2 no usable boundary
+		bool on_grid = false;          // same sweep shape as the first readable run
+		int n = 0, m = 0;
+		PccsModel model;
+		double mean_speed = 0;         // mean relative speed over the sweep
+		std::vector<double> surface;   // mean relative speed of each summary cell
+};
+
+// a significant shift between runs[after] and runs[after + 1]
+struct ChangePoint
+{
+		std::string series;            // a parameter name, or "surface"
+		size_t after;
+		double p_value;
+		double before, after_value;    // segment means (mean relative speed for the surface)
+		double shift;                  // after - before; RMS cell difference for the surface
+};
+
+// fit a time-ordered series of sweeps of one PU and test each parameter and
+// the relative-speed surface for change points. Inputs are read and fitted
+// on `threads` workers (0 = all cores) and only their summaries are kept, so
+// memory does not grow with the sweeps. Each series is split by binary
+// segmentation: the split maximizing the between-segment mean difference is
+// kept when a permutation test of the segment finds it significant, and both
+// halves are searched again. Parameters use the fitted runs, the surface the
+// readable runs on the first run's grid; non-finite values (TBWDC and rate_i
+// of a fit without normal kernels) are left out of their series. changes are
+// ordered by series, then run
+void detect_drift(const std::vector<std::string> &inputs, std::vector<DriftRun> &runs,
+                  std::vector<ChangePoint> &changes, const DriftOptions &options = DriftOptions(),
+                  unsigned threads = 0);
+
+// one row per run (input as table_field), then one row per change point
+void write_drift(FILE *fp, const std::vector<DriftRun> &runs, const std::vector<ChangePoint> &changes,
+                 const DriftOptions &options = DriftOptions());
+
+#endif
@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "incremental.h"
+
+using namespace std;
+
+// derive the running minimum and slope prefix sums of row i from column `from`
+void IncrementalFit::fill_row(int i, int from)
+{
+		int m = sweep_.externalBW.size();
+		const double *s = speed_[i];
+		double *lo = min_speed_[i], *acc = slope_sum_[i];
+		for (int j = from; j < m; ++j)
+		{
+				if (j == 0) { lo[0] = s[0]; acc[0] = 0; continue; }
+				lo[j] = min(lo[j-1], s[j]);
+				acc[j] = acc[j-1] + (s[j-1]-s[j])/(sweep_.externalBW[j]-sweep_.externalBW[j-1]);
+		}
+}
+
+// first column j >= 1 whose total demand reaches TBWDC, m if none
+int IncrementalFit::tbwdc_start(int i) const
+{
+		int lo = 1, hi = sweep_.externalBW.size();
+		while (lo < hi)
+		{
+				int mid = (lo + hi) / 2;
+				if (sweep_.standaloneBW[i] + sweep_.externalBW[mid] >= model_.TBWDC) hi = mid;
+				else lo = mid + 1;
+		}
+		return lo;
+}
+
+// the balance-point scan of fit(), resumed where the last call stopped
+// unless the starting column moved
+void IncrementalFit::scan_row(int i, int start)
+{
+		RowScan &r = scans_[i];
+		if (r.start != start)
+		{
+				r = RowScan();
+				r.start = start;
+				r.next = start;
+		}
+		if (r.brk >= 0) return;
+
+		int j, m = sweep_.externalBW.size();
+		const double *s = speed_[i];
+		for (j = r.next; j < m; ++j)
+		{
+				double cur = (s[j-1]-s[j])/(sweep_.externalBW[j]-sweep_.externalBW[j-1]);
+				if (r.cnt != 0 && cur * thresholds_.balance_factor < r.sum/r.cnt) { r.brk = j; break; }
+				r.sum += cur; r.cnt++;
+		}
+		r.next = j;
+}
+
+void IncrementalFit::refit()
+{
+		int i, j, m = sweep_.externalBW.size();
+		PccsModel &model = model_;
+		Regions regions;
+		status_ = find_regions(sweep_, speed_, PBW_, regions, model, thresholds_);
+		if (status_ != 0 || !regions.minor) return;
+		double reduction = regions.reduction;
+		int normal_boundary = regions.normal_boundary, intensive_boundary = regions.intensive_boundary;
+
+		// the first column whose reduction reaches the threshold is the first
+		// one where the running minimum does
+		double sum = 0;
+		for (i = normal_boundary; i < intensive_boundary; ++i)
+		{
+				const double *lo = min_speed_[i];
+				int a = 0, b = m;
+				while (a < b)
+				{
+						int mid = (a + b) / 2;
+						if ((100-lo[mid]) >= reduction * thresholds_.normal_factor) b = mid;
+						else a = mid + 1;
+				}
+				sum = sum + sweep_.standaloneBW[i]+sweep_.externalBW[min(a, m-1)];
+		}
+		model.TBWDC = sum/(intensive_boundary-normal_boundary);
+
+		balancepoints_.assign(m+2, 0);
+		for (i = normal_boundary; i < intensive_boundary; ++i)
+		{
+				scan_row(i, tbwdc_start(i));
+				const RowScan &r = scans_[i];
+				balancepoints_[(r.brk >= 0 ? r.brk : m)+1]++;
+		}
+		sum = 0.0;
+		for (j = 1; j < m; ++j)
+				sum+=balancepoints_[j]*sweep_.externalBW[j];
+		model.CBP=sum/(intensive_boundary - normal_boundary+1);
+
+		// columns 1..last with externalBW <= CBP form a prefix
+		int last = upper_bound(sweep_.externalBW.begin() + 1, sweep_.externalBW.end(), model.CBP) - sweep_.externalBW.begin() - 1;
+		double rate_sum=0.0;
+		for (i = normal_boundary; i < intensive_boundary; ++i)
+				rate_sum += slope_sum_[i][last];
+		model.rate_i = rate_sum/((double)(intensive_boundary-normal_boundary)*last);
+}
+
+int IncrementalFit::reset(const Sweep &sweep, const FitThresholds &thresholds)
+{
+		int n = sweep.standaloneBW.size(), m = sweep.externalBW.size();
+		sweep_.standaloneBW = sweep.standaloneBW;
+		sweep_.externalBW = sweep.externalBW;
+		thresholds_ = thresholds;
+		PBW_ = relative_speed(sweep, speed_);
+		min_speed_.resize(n, m);
+		slope_sum_.resize(n, m);
+		for (int i = 0; i < n; ++i) fill_row(i, 0);
+		scans_.assign(n, RowScan());
+		refit();
+		return status_;
+}
+
+int IncrementalFit::append_column(double external_bw, const double *achieved)
+{
+		int n = sweep_.standaloneBW.size(), m = sweep_.externalBW.size();
+		if (m > 0 && !(external_bw > sweep_.externalBW[m-1])) return -2;
+		sweep_.externalBW.push_back(external_bw);
+		speed_.grow(n, m+1);
+		min_speed_.grow(n, m+1);
+		slope_sum_.grow(n, m+1);
+		for (int i = 0; i < n; ++i)
+		{
+				PBW_ = max(PBW_, achieved[i]);
+				speed_[i][m] = achieved[i]/sweep_.standaloneBW[i]*100;
+				fill_row(i, m);
+		}
+		refit();
+		return status_;
+}
+
+int IncrementalFit::append_row(double standalone_bw, const double *achieved)
+{
+		int n = sweep_.standaloneBW.size(), m = sweep_.externalBW.size();
+		if (n > 0 && !(standalone_bw > sweep_.standaloneBW[n-1])) return -2;
+		sweep_.standaloneBW.push_back(standalone_bw);
+		speed_.grow(n+1, m);
+		min_speed_.grow(n+1, m);
+		slope_sum_.grow(n+1, m);
+		for (int j = 0; j < m; ++j)
+		{
+				PBW_ = max(PBW_, achieved[j]);
+				speed_[n][j] = achieved[j]/standalone_bw*100;
+		}
+		fill_row(n, 0);
+		scans_.push_back(RowScan());
+		refit();
+		return status_;
+}
@@ -0,0 +1,66 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <vector>
+
+#include "matrix.h"
+#include "pccs.h"
+
+// a fit that follows a sweep as it grows one external BW column or one
+// kernel row at a time. Alongside the relative speeds it keeps, per row,
+// the running minimum speed (so the reduction crossing behind TBWDC is a
+// binary search), the prefix sums of the speed slopes (so rate_i is one
+// lookup per row) and the balance-point scan state, which only has to be
+// redone for rows whose TBWDC starting column moved. An append costs
+// O(n log m + m) plus those rescans, instead of a full O(n m) refit.
+//
+// Columns must arrive in increasing external BW and rows in increasing
+// standalone BW, as fit() assumes. Every parameter matches fit() with the
+// same thresholds on the same data exactly except rate_i, which is summed in
+// a different order and agrees to rounding.
+class IncrementalFit
+{
+public:
+		// start over from a complete sweep, fitting with `thresholds` from now
+		// on; returns the fit status
+		int reset(const Sweep &sweep, const FitThresholds &thresholds = FitThresholds());
+
+		// achieved[i] for each current kernel; returns the fit status, or -2
+		// (state unchanged) if external_bw does not exceed the last level
+		int append_column(double external_bw, const double *achieved);
+
+		// achieved[j] for each current external level; returns the fit status,
+		// or -2 (state unchanged) if standalone_bw does not exceed the last kernel
+		int append_row(double standalone_bw, const double *achieved);
+
+		const PccsModel &model() const { return model_; }
+		int status() const { return status_; }      // as fit(): 0, or -1
+		int rows() const { return sweep_.standaloneBW.size(); }
+		int cols() const { return sweep_.externalBW.size(); }
+
+private:
+		struct RowScan
+		{
+				int start = -1;        // first column at or past TBWDC, -1 = not scanned
+				int next = 0;          // next column to scan
+				int brk = -1;          // column the scan stopped at, -1 = still running
+				double sum = 0;
+				int cnt = 0;
+		};
+
+		void fill_row(int i, int from);
+		int tbwdc_start(int i) const;
+		void scan_row(int i, int start);
+		void refit();
+
+		Sweep sweep_;                  // the BW levels; achievedBW stays empty
+		FitThresholds thresholds_;
+		Matrix speed_, min_speed_, slope_sum_;
+		std::vector<RowScan> scans_;
+		std::vector<int> balancepoints_;
+		double PBW_ = 0;
+		PccsModel model_;
+		int status_ = -1;
+};
+
+#endif
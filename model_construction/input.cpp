@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <vector>
+
+#include "input.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "scanner.h"
+
+using namespace std;
+
+namespace {
+
+// matrices smaller than this are parsed on the calling thread
+#define PARALLEL_PARSE_MIN (4 << 20)
+#define PARALLEL_PARSE_CHUNK (1 << 20)
+
+int fail(const char *path, const char *what)
+{
+		fprintf(stderr, "%s: %s\n", path, what);
+		return -1;
+}
+
+inline bool is_space(char c)
+{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// end of the line starting at p: its '\n', or end
+inline const char *line_end(const char *p, const char *end)
+{
+		const char *q = (const char *)memchr(p, '\n', end - p);
+		return q ? q : end;
+}
+
+inline bool blank(const char *p, const char *e)
+{
+		while (p < e && is_space(*p)) ++p;
+		return p == e;
+}
+
+int parse_matrix_sequential(const char *p, const char *end, Matrix &achieved, int n, int m)
+{
+		Scanner s{p, end};
+		for (int i = 0; i < n; ++i)
+		{
+				double *row = achieved[i];
+				for (int j = 0; j < m; ++j)
+						if (!s.next(row[j])) return -1;
+		}
+		return 0;
+}
+
+// the n*m achieved BWs in [p, end); returns 0, or -1 if a number is malformed
+// or missing. Large matrices written one row per line (as write_input does)
+// are cut into chunks at line breaks: the non-blank lines of every chunk are
+// counted, then the chunks are parsed in parallel, each from the row its
+// count puts it at. Any other layout is scanned sequentially.
+int parse_matrix(const char *p, const char *end, Matrix &achieved, int n, int m, unsigned threads)
+{
+		size_t bytes = end - p;
+		if (threads == 0) threads = default_threads();
+		if (threads == 1 || bytes < PARALLEL_PARSE_MIN) return parse_matrix_sequential(p, end, achieved, n, m);
+
+		size_t chunks = bytes / PARALLEL_PARSE_CHUNK;
+		vector<const char *> bound(chunks + 1);
+		bound[0] = p;
+		bound[chunks] = end;
+		for (size_t c = 1; c < chunks; ++c)
+		{
+				const char *b = max(p + bytes / chunks * c, bound[c-1]);
+				bound[c] = b < end ? min(line_end(b, end) + 1, end) : end;
+		}
+		vector<size_t> first(chunks + 1, 0);
+		parallel_for(chunks, [&](size_t c, unsigned) {
+				size_t rows = 0;
+				for (const char *q = bound[c], *e; q < bound[c+1]; q = e + 1)
+				{
+						e = line_end(q, bound[c+1]);
+						rows += !blank(q, e);
+				}
+				first[c+1] = rows;
+		}, threads);
+		for (size_t c = 0; c < chunks; ++c) first[c+1] += first[c];
+
+		// a line that is not exactly one row sends the whole matrix to the sequential scan
+		atomic<bool> regular(first[chunks] >= (size_t)n);
+		if (regular) parallel_for(chunks, [&](size_t c, unsigned) {
+				size_t i = first[c];
+				for (const char *q = bound[c], *e; q < bound[c+1] && i < (size_t)n && regular; q = e + 1)
+				{
+						e = line_end(q, bound[c+1]);
+						if (blank(q, e)) continue;
+						Scanner s{q, e};
+						double *row = achieved[i++];
+						for (int j = 0; j < m; ++j)
+								if (!s.next(row[j])) { regular = false; return; }
+						s.skip_ws();
+						if (s.p != e) { regular = false; return; }
+				}
+		}, threads);
+		return regular ? 0 : parse_matrix_sequential(p, end, achieved, n, m);
+}
+
+}
+
+int read_input(const char *path, Sweep &sweep, ParseStats *stats, unsigned threads)
+{
+		auto start = chrono::steady_clock::now();
+		MappedFile file;
+		if (!file.open(path)) return fail(path, "cannot open input file");
+
+		Scanner s{file.data, file.data + file.size};
+		int i, j, n, m;
+
+		if (!s.next(n) || n <= 0) return fail(path, "bad kernel count");
+		sweep.standaloneBW.resize(n);
+		for (i = 0; i < n; ++i)
+				if (!s.next(sweep.standaloneBW[i])) return fail(path, "bad standalone BW");
+
+		if (!s.next(m) || m <= 0) return fail(path, "bad external BW count");
+		sweep.externalBW.resize(m);
+		for (j = 0; j < m; ++j)
+				if (!s.next(sweep.externalBW[j])) return fail(path, "bad external BW");
+
+		sweep.achievedBW.resize(n, m);
+		if (parse_matrix(s.p, s.end, sweep.achievedBW, n, m, threads) != 0) return fail(path, "bad or missing achieved BW");
+
+		if (stats)
+		{
+				stats->bytes = file.size;
+				stats->seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		}
+		return 0;
+}
+
+int write_input(const char *path, const Sweep &sweep)
+{
+		FILE *fp = fopen(path, "w");
+		if (fp == NULL) return fail(path, "cannot open output file");
+
+		int n = sweep.standaloneBW.size(), m = sweep.externalBW.size();
+		vector<char> buf(1 << 16);
+		size_t len = 0;
+		bool ok = true;
+		auto flush = [&]() { ok = ok && fwrite(buf.data(), 1, len, fp) == len; len = 0; };
+		auto put = [&](double v, char sep) {
+				if (buf.size() - len < 32) flush();
+				len = to_chars(buf.data() + len, buf.data() + buf.size(), v).ptr - buf.data();
+				buf[len++] = sep;
+		};
+
+		fprintf(fp, "%d\n", n);
+		for (int i = 0; i < n; ++i) put(sweep.standaloneBW[i], i + 1 < n ? ' ' : '\n');
+		flush();
+		fprintf(fp, "%d\n", m);
+		for (int j = 0; j < m; ++j) put(sweep.externalBW[j], j + 1 < m ? ' ' : '\n');
+		flush();
+		fputc('\n', fp);
+		for (int i = 0; i < n; ++i)
+				for (int j = 0; j < m; ++j) put(sweep.achievedBW[i][j], j + 1 < m ? '\t' : '\n');
+		flush();
+		ok = (fclose(fp) == 0) && ok;
+		return ok ? 0 : fail(path, "write failed");
+}
@@ -0,0 +1,24 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+
+#include "pccs.h"
+
+struct ParseStats
+{
+		size_t bytes = 0;
+		double seconds = 0;
+};
+
+// parse an input file (n, n standalone BWs, m, m external BWs, n*m achieved BWs)
+// returns 0 on success, -1 on I/O or format error (message on stderr). Large
+// matrices are parsed on `threads` workers (0 = all cores); callers that
+// already read several inputs in parallel pass 1
+int read_input(const char *path, Sweep &sweep, ParseStats *stats = nullptr, unsigned threads = 0);
+
+// write a sweep in the same format (shortest round-trip decimals)
+// returns 0, or -1 on I/O error
+int write_input(const char *path, const Sweep &sweep);
+
+#endif
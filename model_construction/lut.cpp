@@ -0,0 +1,120 @@
+#include <math.h>
+#include <algorithm>
+
+#include "lut.h"
+
+using namespace std;
+
+namespace {
+
+// one block of rows per region; the minor and intensive regions do not
+// depend on own BW and take one row each (stored twice, so every lookup reads
+// a full cell), the normal region own_steps cells between its boundaries.
+// One extra column repeats the last grid point, so a lookup on the upper edge
+// still reads a full cell
+struct Table
+{
+		struct Block
+		{
+				size_t row = 0;              // first table row
+				double origin = 0, scale = 0, last = 0;
+		};
+
+		vector<float> cells;
+		size_t stride = 0;
+		Block block[3];                      // minor, normal, intensive
+		double normal_BW = 0, intensive_BW = 0;
+		double ext_scale = 0, ext_last = 0, ext_max = 0;
+
+		void build(const PccsModel &model, int own_steps, int ext_steps);
+		double relative_speed(double own_bw, double external_bw) const;
+};
+
+void Table::build(const PccsModel &model, int own_steps, int ext_steps)
+{
+		own_steps = max(own_steps, 1);
+		ext_steps = max(ext_steps, 1);
+		// a model without a minor region has CBP 0; any range will do
+		ext_max = model.CBP > 0 ? model.CBP : 1;
+		ext_scale = ext_steps / ext_max;
+		ext_last = ext_steps;
+		normal_BW = model.normal_BW;
+		intensive_BW = model.intensive_BW;
+
+		// rows 0-1 minor, 2 .. own_steps+2 normal, then 2 intensive; every
+		// row is sampled at an own BW inside its region, the normal region's
+		// top row just below intensive_BW
+		double top = nextafter(model.intensive_BW, -INFINITY);
+		vector<double> own;
+		own.push_back(model.normal_BW / 2);
+		own.push_back(model.normal_BW / 2);
+		for (int i = 0; i <= own_steps; ++i)
+				own.push_back(i == own_steps ? top : model.normal_BW + (model.intensive_BW - model.normal_BW) * i / own_steps);
+		own.push_back(model.intensive_BW);
+		own.push_back(model.intensive_BW);
+
+		block[0].row = 0;
+		block[1].row = 2;
+		block[1].origin = model.normal_BW;
+		block[1].scale = model.intensive_BW > model.normal_BW ? own_steps / (model.intensive_BW - model.normal_BW) : 0;
+		block[1].last = nextafter((double)own_steps, 0.0);
+		block[2].row = own_steps + 3;
+
+		stride = ext_steps + 2;
+		cells.resize(own.size() * stride);
+		for (size_t i = 0; i < own.size(); ++i)
+		{
+				float *row = &cells[i * stride];
+				for (int j = 0; j <= ext_steps + 1; ++j)
+						row[j] = predict_relative_speed(model, own[i], ext_max * min(j, ext_steps) / ext_steps);
+		}
+}
+
+double Table::relative_speed(double own_bw, double external_bw) const
+{
+		const Block &b = block[(own_bw >= normal_BW) + (own_bw >= intensive_BW)];
+		double x = min(max((own_bw - b.origin) * b.scale, 0.0), b.last);
+		double y = min(max(external_bw * ext_scale, 0.0), ext_last);
+		int i = (int)x, j = (int)y;
+		double fx = x - i, fy = y - j;
+		const float *r0 = &cells[(b.row + i) * stride + j], *r1 = r0 + stride;
+		double top = r0[0] + (r0[1] - r0[0]) * fy;
+		double bottom = r1[0] + (r1[1] - r1[0]) * fy;
+		return top + (bottom - top) * fx;
+}
+
+}
+
+void lut_error(const PccsModel &model, int own_steps, int ext_steps, LutError &error, int oversample)
+{
+		Table lut;
+		lut.build(model, own_steps, ext_steps);
+		error = LutError();
+		error.own_steps = own_steps;
+		error.ext_steps = ext_steps;
+		error.bytes = lut.cells.size() * sizeof(float);
+		int nx = (int)(own_steps * oversample * 1.1), ny = (int)(ext_steps * oversample * 1.1);
+		double sum = 0;
+		for (int i = 0; i <= nx; ++i)
+		{
+				double own = model.intensive_BW * 1.1 * i / nx;
+				for (int j = 0; j <= ny; ++j)
+				{
+						double ext = lut.ext_max * 1.1 * j / ny;
+						double exact = predict_relative_speed(model, own, ext), approx = lut.relative_speed(own, ext);
+						double d = fabs(approx - exact);
+						sum += d;
+						error.max_error = max(error.max_error, d);
+						if (exact > 0) error.max_slowdown_error = max(error.max_slowdown_error, fabs(exact / approx - 1));
+				}
+		}
+		error.mean_error = sum / ((double)(nx + 1) * (ny + 1));
+}
+
+void write_lut_errors(FILE *fp, const vector<LutError> &errors)
+{
+		fprintf(fp, "# own_steps ext_steps bytes max_error mean_error max_slowdown_error\n");
+		for (const LutError &e : errors)
+				fprintf(fp, "%d %d %zu %lf %lf %lf\n", e.own_steps, e.ext_steps, e.bytes,
+				        e.max_error, e.mean_error, e.max_slowdown_error);
+}
@@ -0,0 +1,34 @@
+#ifndef LUT_H
+#define LUT_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "pccs.h"
+
+// how much precision a lookup table of predict_relative_speed() would lose.
+// The table interpolates bilinearly over (own BW, external BW); the minor,
+// normal and intensive regions get their own rows, so the jumps at normal_BW
+// and intensive_BW stay exact, and external BW spans [0, CBP], past which the
+// model is flat. What error remains sits in the cells crossed by the CBP and
+// TBWDC kinks and shrinks with the step size. No query path is provided: the
+// exact model costs about a dozen flops and beats any table read, scalar
+// (about 3 ns against 8 ns) and batched (predict_batch.h, about 1 ns)
+struct LutError
+{
+		int own_steps = 0, ext_steps = 0;
+		size_t bytes = 0;
+		double max_error = 0;          // percentage points of relative speed
+		double mean_error = 0;
+		double max_slowdown_error = 0; // relative, where the exact speed is > 0
+};
+
+// tabulate the model with own_steps x ext_steps cells in the normal region
+// and compare the table against the exact model on a grid `oversample` times
+// finer, over own BW up to 1.1 intensive_BW and external BW up to 1.1 CBP
+void lut_error(const PccsModel &model, int own_steps, int ext_steps, LutError &error, int oversample = 8);
+
+// one row per resolution: steps, bytes, errors
+void write_lut_errors(FILE *fp, const std::vector<LutError> &errors);
+
+#endif
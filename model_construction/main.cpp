@@ -1,143 +1,479 @@
 #include <stdio.h>
-#include <math.h>
 #include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
 #include <vector>
-#include <algorithm>
 
-#define threshold_minor 80
-#define eps 1e-8
+#include "batch.h"
+#include "bootstrap.h"
+#include "cache.h"
+#include "corun.h"
+#include "diagnostics.h"
+#include "drift.h"
+#include "input.h"
+#include "lut.h"
+#include "modeldb.h"
+#include "pccs.h"
+#include "placement.h"
+#include "planner.h"
+#include "search.h"
+#include "surface.h"
+#include "trace.h"
+#include "validate.h"
 
 using namespace std;
 
-int main(int argc,char *argv[])
+static void usage()
 {
-		if (argc < 3) {
-				printf("\n Need an input file and an output file\n./main inputfile outputfile\n");
-				return 0;
+		printf("\n Need an input file and an output file\n./main inputfile outputfile\n");
+		printf("./main --batch directory|manifest outputfile [threads]\n");
+		printf("./main --export-db dbfile manifest [threads]\n");
+		printf("./main --query-db dbfile device pu\n");
+		printf("./main --plan inputfile outputfile [tolerance patience]\n");
+		printf("./main --bootstrap inputfile outputfile [iterations level threads]\n");
+		printf("./main --search inputfile outputfile [gridfile threads]\n");
+		printf("./main --corun dbfile device pu=standaloneBW pu=standaloneBW ...\n");
+		printf("./main --place dbfile device taskgraph outputfile [beam]\n");
+		printf("./main --replay dbfile device pu=tracefile pu=tracefile ...\n");
+		printf("./main --lut modelfile outputfile [steps steps ...]\n");
+		printf("./main --refine inputfile outputfile [factor finesweepfile]\n");
+		printf("./main --validate inputfile outputfile [folds threads]   (folds 0 = leave one column out)\n");
+		printf("./main --drift directory|manifest outputfile [alpha threads]   (runs in time order)\n");
+		printf("./main --diagnostics inputfile outputfile [json|csv]\n");
+		printf("fits are cached in the directory named by $PCCS_CACHE, if set\n");
+}
+
+static FILE *open_output(const char *path)
+{
+		FILE * output = fopen(path,"w");
+		if (output == NULL) fprintf(stderr, "%s: cannot open output file\n", path);
+		return output;
+}
+
+// fit every matrix in a directory or manifest into one table
+static int batch_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		vector<string> inputs;
+		if (list_inputs(argv[2], inputs) != 0) return 1;
+		unsigned threads = argc > 4 ? atoi(argv[4]) : 0;
+
+		auto start = chrono::steady_clock::now();
+		vector<BatchResult> results;
+		fit_batch(inputs, results, threads);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		write_batch(output, results);
+		fclose(output);
+
+		int failed = 0;
+		for (const BatchResult &r : results) failed += r.status != 0;
+		fprintf(stderr, "fitted %zu inputs (%d failed) in %.3f s\n", results.size(), failed, seconds);
+		return failed ? 1 : 0;
+}
+
+// build a binary model database from text models and/or input matrices
+static int export_db_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		unsigned threads = argc > 4 ? atoi(argv[4]) : 0;
+		return export_model_db(argv[2], argv[3], threads) == 0 ? 0 : 1;
+}
+
+// print one model from a binary database in the text format
+static int query_db_main(int argc, char *argv[])
+{
+		if (argc < 5) { usage(); return 0; }
+		ModelDb db;
+		if (db.open(argv[2]) != 0) return 1;
+		const ModelRecord *r = db.find(argv[3], argv[4]);
+		if (r == NULL) { fprintf(stderr, "%s/%s: not in %s\n", argv[3], argv[4], argv[2]); return 1; }
+		write_model(stdout, r->model);
+		return 0;
+}
+
+// predict the slowdown of several PUs of one device running together
+static int corun_main(int argc, char *argv[])
+{
+		if (argc < 5) { usage(); return 0; }
+		ModelDb db;
+		if (db.open(argv[2]) != 0) return 1;
+		vector<CorunPu> pus;
+		vector<string> names;
+		for (int a = 4; a < argc; ++a)
+		{
+				const char *eq = strchr(argv[a], '=');
+				if (eq == NULL) { fprintf(stderr, "%s: expected pu=standaloneBW\n", argv[a]); return 1; }
+				string pu(argv[a], eq - argv[a]);
+				const ModelRecord *r = db.find(argv[3], pu.c_str());
+				if (r == NULL) { fprintf(stderr, "%s/%s: not in %s\n", argv[3], pu.c_str(), argv[2]); return 1; }
+				CorunPu p;
+				p.model = r->model;
+				p.standalone_bw = atof(eq + 1);
+				pus.push_back(p);
+				names.push_back(pu);
 		}
-		int i, j, k, n, m;
 
-		double MRMC = 0, CBP = 0, TBWDC = 0, rate_i = 0, normal_BW = 0, intensive_BW = 0, PBW = 0;
-		int flag_minor=0, flag_normal=0, flag_intensive=0;
-		FILE * fp = fopen(argv[1],"r");
-		FILE * output = fopen(argv[2],"w");
-		vector <double> standaloneBW, externalBW;
-		vector <vector<double> > achievedBW;
-		vector <vector<double> > achieved_relative_speed;
+		CorunResult result;
+		int status = predict_corun(pus.data(), pus.size(), result);
+		printf("# pu standalone_BW achieved_BW external_BW relative_speed slowdown\n");
+		for (size_t k = 0; k < pus.size(); ++k)
+				printf("%s %lf %lf %lf %lf %lf\n", names[k].c_str(), pus[k].standalone_bw, result.achieved_bw[k],
+				       result.external_bw[k], result.relative_speed[k], result.slowdown[k]);
+		if (status != 0) fprintf(stderr, "not converged after %d iterations (residual %g)\n",
+		                         result.iterations, result.residual);
+		return status == 0 ? 0 : 1;
+}
 
+// lookup-table error against the exact model at several resolutions
+static int lut_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		FILE *fp = fopen(argv[2], "r");
+		if (fp == NULL) { fprintf(stderr, "%s: cannot open model file\n", argv[2]); return 1; }
+		PccsModel model;
+		int status = read_model(fp, model);
+		fclose(fp);
+		if (status != 0) { fprintf(stderr, "%s: not a model file\n", argv[2]); return 1; }
 
-		fscanf(fp, "%d", &n);
-		achievedBW.resize(n);
-		achieved_relative_speed.resize(n);
-		for (i = 0; i < n; ++i)
+		vector<int> steps;
+		for (int a = 4; a < argc; ++a) steps.push_back(atoi(argv[a]));
+		if (steps.empty()) steps = {16, 32, 64, 128, 256};
+		vector<LutError> errors;
+		for (int n : steps)
 		{
-				double tmp;
-				fscanf(fp, "%lf", &tmp);
-				standaloneBW.push_back(tmp);
+				LutError e;
+				lut_error(model, n, n, e);
+				errors.push_back(e);
 		}
 
-		fscanf(fp, "%d", &m);
-		for (i = 0; i < m; ++i)
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		write_lut_errors(output, errors);
+		fclose(output);
+		return 0;
+}
+
+// end-to-end slowdown of co-running applications from their BW traces
+static int replay_main(int argc, char *argv[])
+{
+		if (argc < 5) { usage(); return 0; }
+		ModelDb db;
+		if (db.open(argv[2]) != 0) return 1;
+		vector<ReplayApp> apps;
+		vector<string> names;
+		for (int a = 4; a < argc; ++a)
+		{
+				const char *eq = strchr(argv[a], '=');
+				if (eq == NULL) { fprintf(stderr, "%s: expected pu=tracefile\n", argv[a]); return 1; }
+				string pu(argv[a], eq - argv[a]);
+				const ModelRecord *r = db.find(argv[3], pu.c_str());
+				if (r == NULL) { fprintf(stderr, "%s/%s: not in %s\n", argv[3], pu.c_str(), argv[2]); return 1; }
+				ReplayApp app;
+				app.model = r->model;
+				app.trace = eq + 1;
+				apps.push_back(app);
+				names.push_back(pu);
+		}
+
+		auto start = chrono::steady_clock::now();
+		vector<ReplayStats> stats;
+		size_t bytes = 0;
+		if (replay_traces(apps, stats, &bytes) != 0) return 1;
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		printf("# pu trace intervals standalone_time corun_time slowdown\n");
+		for (size_t k = 0; k < apps.size(); ++k)
+				printf("%s %s %ld %lf %lf %lf\n", names[k].c_str(), apps[k].trace.c_str(), stats[k].intervals,
+				       stats[k].standalone_time, stats[k].corun_time, stats[k].slowdown());
+		fprintf(stderr, "replayed %.1f MB in %.3f s, %.1f MB/s\n", bytes / 1e6, seconds,
+		        seconds > 0 ? bytes / 1e6 / seconds : 0.0);
+		return 0;
+}
+
+// assign every task of a pipeline to a PU of one device, minimizing the
+// predicted makespan under contention
+static int place_main(int argc, char *argv[])
+{
+		if (argc < 6) { usage(); return 0; }
+		ModelDb db;
+		if (db.open(argv[2]) != 0) return 1;
+		TaskGraph graph;
+		if (read_task_graph(argv[4], graph) != 0) return 1;
+		vector<PccsModel> models;
+		for (const string &pu : graph.pus)
 		{
-				double tmp;
-				fscanf(fp, "%lf", &tmp);
-				externalBW.push_back(tmp);
+				const ModelRecord *r = db.find(argv[3], pu.c_str());
+				if (r == NULL) { fprintf(stderr, "%s/%s: not in %s\n", argv[3], pu.c_str(), argv[2]); return 1; }
+				models.push_back(r->model);
 		}
+		PlaceOptions options;
+		if (argc > 6) options.beam = atoi(argv[6]);
 
-		for (i = 0; i < n; ++i)
-				for (j = 0; j < m; ++j)
-				{
-						double tmp;
-						fscanf(fp, "%lf", &tmp);
-						achievedBW[i].push_back(tmp);
-						PBW = max(PBW, tmp);
-				}
-
-		// calculate achieved_relative_speed percentage
-
-		for (i = 0; i < n; ++i)
-				for (j = 0; j < m; ++j)
-				{
-						achieved_relative_speed[i].push_back(achievedBW[i][j]/standaloneBW[i]*100);
-				}
-
-		// determine the boundary between minor region and normal region
-		// first branch is for no minor region case
-		// second branch is to find the
-		if (achieved_relative_speed[0][m-1] < threshold_minor) {flag_minor = -1; MRMC = -1; normal_BW = 0;}
-		else
+		auto start = chrono::steady_clock::now();
+		Placement placement;
+		if (place_tasks(graph, models, placement, options) != 0) return 1;
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		// reference: every task on its fastest PU when run alone, in file order
+		Placement fastest;
+		for (size_t t = 0; t < graph.tasks.size(); ++t)
+		{
+				const PlaceTask &task = graph.tasks[t];
+				int best = -1;
+				for (size_t p = 0; p < graph.pus.size(); ++p)
+						if (task.time[p] >= 0 && (best < 0 || task.time[p] < task.time[best])) best = p;
+				fastest.pu.push_back(best);
+				fastest.start.push_back(t);
+		}
+		simulate_placement(graph, models, fastest);
+
+		FILE * output = open_output(argv[5]);
+		if (output == NULL) return 1;
+		write_placement(output, graph, placement);
+		fclose(output);
+		fprintf(stderr, "%zu tasks placed in %.3f s (%ld co-run solves): makespan %lf, fastest-PU placement %lf\n",
+		        graph.tasks.size(), seconds, placement.evaluations, placement.makespan, fastest.makespan);
+		return 0;
+}
+
+// replay the adaptive planner against a fully measured sweep and write the
+// reduced experiment list it would have run
+static int plan_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		Sweep sweep;
+		if (read_input(argv[2], sweep) != 0) return 1;
+		PlannerOptions options;
+		if (argc > 4) options.tolerance = atof(argv[4]);
+		if (argc > 5) options.patience = atoi(argv[5]);
+
+		Planner planner(sweep.standaloneBW, sweep.externalBW, options);
+		for (;;)
 		{
-				double reduction = min(100 - achieved_relative_speed[0][m-1], 95.0);
-				int l, normal_boundary, intensive_boundary;
-				for (i = 0; i < n; ++i)
-				{
-						if (reduction * 2 < (100-achieved_relative_speed[i][m-1])) break;
-				}
-				normal_boundary = i; normal_BW = standaloneBW[i-1]; MRMC = 100- achieved_relative_speed[i-1][m-1];
-				for (j = 0; j < m; ++j)
-				{
-						if ((100-achieved_relative_speed[i][j]) >= reduction * 2) break;
-				}
-
-				for (k = i; k < n; ++k)
-				{
-						if ((100-achieved_relative_speed[k][0] >= reduction * 2)) break;
-				}
-				if (k == n) {flag_intensive = -1; intensive_BW=PBW; intensive_boundary=n;}
-				else { intensive_BW=standaloneBW[k]; intensive_boundary = k;}
-
-				double sum = 0;
-				for (i = normal_boundary; i < intensive_boundary; ++i)
-				{
-						for (j = 0; j < m; ++j)
-						{
-								if ((100-achieved_relative_speed[i][j]) >= reduction * 2) break;
-						}
-						sum = sum + standaloneBW[i]+externalBW[j];
-				}
-				TBWDC = sum/(intensive_boundary-normal_boundary);
-
-
-				vector <int> balancepoints(m,0);
-				for (i = normal_boundary; i < intensive_boundary; ++i)
-				{
-						double sum = 0.0, cur; int cnt = 0;
-						for (j = 1; j < m; ++j)
-						{
-								if (standaloneBW[i] + externalBW[j] >= TBWDC)
-								{
-										cur = (achieved_relative_speed[i][j-1]-achieved_relative_speed[i][j])/(externalBW[j]-externalBW[j-1]);
-										if (cnt != 0) {
-												if (cur * 3 < sum/cnt)  {break;}
-										}
-										sum+= cur; cnt++;
-								}
-						}
-						balancepoints[j+1]++;
-				}
-				sum = 0.0; int cnt = 0;
-				for (j = 1; j < m; ++j)
-						sum+=balancepoints[j]*externalBW[j];
-				CBP=sum/(intensive_boundary - normal_boundary+1);
-				double rate_sum=0.0; int rate_cnt = 0;
-				for (i = normal_boundary; i < intensive_boundary; ++i)
-						for (j = 1; j < m; ++j)
-								if (externalBW[j]<=CBP)
-								{
-										rate_sum+=(achieved_relative_speed[i][j-1]-achieved_relative_speed[i][j])/(externalBW[j]-externalBW[j-1]);
-										rate_cnt++;
-								}
-
-				rate_i = rate_sum/rate_cnt;
+				vector<pair<int, int> > cells = planner.next();
+				if (cells.empty()) break;
+				for (auto &c : cells) planner.record(c.first, c.second, sweep.achievedBW[c.first][c.second]);
+		}
+
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		fprintf(output, "# kernel external standaloneBW externalBW\n");
+		for (auto &c : planner.history())
+				fprintf(output, "%d %d %lf %lf\n", c.first, c.second, sweep.standaloneBW[c.first], sweep.externalBW[c.second]);
+		fclose(output);
+
+		PccsModel full;
+		int full_status = fit(sweep, full);
+		int total = sweep.standaloneBW.size() * sweep.externalBW.size();
+		fprintf(stderr, "measured %d of %d cells (%.1f%%), %s\n", planner.measured_count(), total,
+		        100.0 * planner.measured_count() / total, planner.converged() ? "converged" : "not converged");
+		fprintf(stderr, "planned fit (status %d):\n", planner.status());
+		write_model(stderr, planner.model());
+		fprintf(stderr, "full fit (status %d):\n", full_status);
+		write_model(stderr, full);
+		return 0;
+}
+
+// fit on a PCHIP-interpolated grid `factor` times finer than the measured one
+static int refine_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		Sweep sweep, fine;
+		if (read_input(argv[2], sweep) != 0) return 1;
+		int factor = argc > 4 ? atoi(argv[4]) : 10;
+		if (refine_sweep(sweep, factor, fine) != 0) {
+				fprintf(stderr, "%s: cannot refine by %d (BW levels must increase)\n", argv[2], factor);
+				return 1;
+		}
+		if (argc > 5 && write_input(argv[5], fine) != 0) return 1;
+
+		PccsModel coarse, model;
+		int coarse_status = fit(sweep, coarse);
+		if (fit(fine, model) != 0) {
+				fprintf(stderr, "%s: no minor/normal region boundary found on the fine grid\n", argv[2]);
+				return 1;
+		}
+
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		write_model(output, model);
+		fclose(output);
+		fprintf(stderr, "fitted %zu x %zu fine grid; measured grid fit (status %d):\n",
+		        fine.standaloneBW.size(), fine.externalBW.size(), coarse_status);
+		write_model(stderr, coarse);
+		return 0;
+}
+
+// held-out prediction error of the fit, per region
+static int validate_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		Sweep sweep;
+		if (read_input(argv[2], sweep) != 0) return 1;
+		int folds = argc > 4 ? atoi(argv[4]) : 10;
+		unsigned threads = argc > 5 ? atoi(argv[5]) : 0;
+
+		auto start = chrono::steady_clock::now();
+		ValidationResult result;
+		if (cross_validate(sweep, folds, result, threads) != 0) {
+				fprintf(stderr, "%s: no minor/normal region boundary found\n", argv[2]);
+				return 1;
+		}
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		write_validation(output, result);
+		fclose(output);
+		fprintf(stderr, "%d folds in %.3f s\n", result.folds, seconds);
+		return 0;
+}
+
+// confidence intervals for the six parameters by residual bootstrap
+static int bootstrap_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		Sweep sweep;
+		if (read_input(argv[2], sweep) != 0) return 1;
+		int iterations = argc > 4 ? atoi(argv[4]) : 2000;
+		double level = argc > 5 ? atof(argv[5]) : 0.95;
+		unsigned threads = argc > 6 ? atoi(argv[6]) : 0;
+		// a fraction: 0.95, not 95
+		if (!(level > 0 && level < 1)) { usage(); return 1; }
+
+		auto start = chrono::steady_clock::now();
+		BootstrapResult result;
+		if (bootstrap(sweep, iterations, level, result, threads) != 0) {
+				fprintf(stderr, "%s: no minor/normal region boundary found\n", argv[2]);
+				return 1;
+		}
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		write_bootstrap(output, result);
+		fclose(output);
+		fprintf(stderr, "%d resamples in %.3f s\n", iterations, seconds);
+		return 0;
+}
+
+// fit with every combination of cut-offs and keep the best-predicting model
+static int search_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		Sweep sweep;
+		if (read_input(argv[2], sweep) != 0) return 1;
+		ThresholdGrid grid;
+		if (argc > 4 && read_grid(argv[4], grid) != 0) return 1;
+		unsigned threads = argc > 5 ? atoi(argv[5]) : 0;
+
+		auto start = chrono::steady_clock::now();
+		vector<SearchResult> results;
+		int best = threshold_search(sweep, grid, results, threads);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		write_search(output, results, best);
+		fclose(output);
+		fprintf(stderr, "%zu candidates in %.3f s\n", results.size(), seconds);
+		if (best < 0) {
+				fprintf(stderr, "%s: no candidate found a minor/normal region boundary\n", argv[2]);
+				return 1;
+		}
+		return 0;
+}
+
+// change points in the parameters and speed surface across a series of runs
+static int drift_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		vector<string> inputs;
+		if (list_inputs(argv[2], inputs) != 0) return 1;
+		DriftOptions options;
+		if (argc > 4) options.alpha = atof(argv[4]);
+		unsigned threads = argc > 5 ? atoi(argv[5]) : 0;
+
+		auto start = chrono::steady_clock::now();
+		vector<DriftRun> runs;
+		vector<ChangePoint> changes;
+		detect_drift(inputs, runs, changes, options, threads);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		FILE * output = open_output(argv[3]);
+		if (output == NULL) return 1;
+		write_drift(output, runs, changes, options);
+		fclose(output);
+		fprintf(stderr, "%zu runs, %zu change points in %.3f s\n", runs.size(), changes.size(), seconds);
+		return 0;
+}
+
+// the fit with its intermediate quantities, as JSON or CSV
+static int diagnostics_main(int argc, char *argv[])
+{
+		if (argc < 4) { usage(); return 0; }
+		DiagnosticsFormat format = DIAG_JSON;
+		if (argc > 4 && strcmp(argv[4], "csv") == 0) format = DIAG_CSV;
+		else if (argc > 4 && strcmp(argv[4], "json") != 0) { usage(); return 1; }
+		Sweep sweep;
+		if (read_input(argv[2], sweep) != 0) return 1;
+
+		auto start = chrono::steady_clock::now();
+		FitDiagnostics diag;
+		if (diagnose_fit(sweep, diag) != 0)
+				fprintf(stderr, "%s: no minor/normal region boundary found\n", argv[2]);
+		if (write_diagnostics(argv[3], format, argv[2], sweep, diag) != 0) return 1;
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		fprintf(stderr, "fit and diagnostics written in %.3f s\n", seconds);
+		return diag.status == 0 ? 0 : 1;
+}
+
+int main(int argc,char *argv[])
+{
+		if (argc >= 2 && strcmp(argv[1], "--batch") == 0) return batch_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--export-db") == 0) return export_db_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--query-db") == 0) return query_db_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--plan") == 0) return plan_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--bootstrap") == 0) return bootstrap_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--search") == 0) return search_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--corun") == 0) return corun_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--place") == 0) return place_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--replay") == 0) return replay_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--lut") == 0) return lut_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--validate") == 0) return validate_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--drift") == 0) return drift_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--diagnostics") == 0) return diagnostics_main(argc, argv);
+		if (argc >= 2 && strcmp(argv[1], "--refine") == 0) return refine_main(argc, argv);
+		if (argc < 3) {
+				usage();
+				return 0;
+		}
+
+		Sweep sweep;
+		ParseStats stats;
+		if (read_input(argv[1], sweep, &stats) != 0) return 1;
+		fprintf(stderr, "parsed %d x %d matrix (%.1f MB) in %.3f ms, %.1f MB/s\n",
+		        (int)sweep.standaloneBW.size(), (int)sweep.externalBW.size(),
+		        stats.bytes / 1e6, stats.seconds * 1e3,
+		        stats.seconds > 0 ? stats.bytes / 1e6 / stats.seconds : 0.0);
 
+		PccsModel model;
+		bool hit;
+		int status = fit_cached(sweep, model, default_cache_dir(), &hit);
+		if (hit) fprintf(stderr, "model cache hit\n");
+		if (status != 0) {
+				fprintf(stderr, "%s: no minor/normal region boundary found\n", argv[1]);
+				return 1;
 		}
 
-		fprintf(output, "Normal BW %lf\n", normal_BW);
-		fprintf(output, "intensive BW %lf\n", intensive_BW);
-		fprintf(output, "MRMC %lf\n", MRMC);
-		fprintf(output, "TBWDC %lf\n", TBWDC);
-		fprintf(output, "CBP %lf\n", CBP);
-		fprintf(output, "rate_i %lf\n", rate_i);
+		FILE * output = open_output(argv[2]);
+		if (output == NULL) return 1;
+		write_model(output, model);
+		fclose(output);
 
 		return 0;
 
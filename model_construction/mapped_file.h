@@ -0,0 +1,47 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// read-only mapping of a whole file; an empty file maps to size 0
+struct MappedFile
+{
+		const char *data = nullptr;
+		size_t size = 0;
+
+		MappedFile() {}
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+		~MappedFile() { close(); }
+
+		bool open(const char *path)
+		{
+				close();
+				int fd = ::open(path, O_RDONLY);
+				if (fd < 0) return false;
+				struct stat st;
+				if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+				size = st.st_size;
+				if (size > 0)
+				{
+						void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+						if (p == MAP_FAILED) { ::close(fd); size = 0; return false; }
+						madvise(p, size, MADV_SEQUENTIAL);
+						data = (const char *)p;
+				}
+				::close(fd);
+				return true;
+		}
+
+		void close()
+		{
+				if (data) munmap((void *)data, size);
+				data = nullptr; size = 0;
+		}
+};
+
+#endif
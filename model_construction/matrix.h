@@ -0,0 +1,124 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+
+#define MATRIX_ALIGN 64
+
+// strided view over one column of a row-major matrix
+struct ColumnView
+{
+		const double *p;
+		size_t stride;
+		int size;
+
+		double operator[](int i) const { return p[i * stride]; }
+};
+
+// dense row-major matrix of doubles held in one cache-line aligned block;
+// every row starts on a cache line so m[i][j] never straddles rows
+class Matrix
+{
+public:
+		Matrix() {}
+		Matrix(int rows, int cols) { resize(rows, cols); }
+		Matrix(const Matrix &o) { *this = o; }
+		Matrix(Matrix &&o) noexcept { swap(o); }
+		~Matrix() { free(data_); }
+
+		Matrix &operator=(const Matrix &o)
+		{
+				if (this != &o)
+				{
+						resize(o.rows_, o.cols_);
+						if (data_) memcpy(data_, o.data_, bytes());
+				}
+				return *this;
+		}
+		Matrix &operator=(Matrix &&o) noexcept { swap(o); return *this; }
+
+		void swap(Matrix &o) noexcept
+		{
+				std::swap(data_, o.data_);
+				std::swap(rows_, o.rows_);
+				std::swap(cols_, o.cols_);
+				std::swap(stride_, o.stride_);
+				std::swap(capacity_, o.capacity_);
+		}
+
+		// zero-filled; reuses the existing block when it is large enough
+		void resize(int rows, int cols)
+		{
+				const size_t per_line = MATRIX_ALIGN / sizeof(double);
+				size_t stride = (cols + per_line - 1) / per_line * per_line;
+				reserve_exact((size_t)rows * stride);
+				rows_ = rows; cols_ = cols; stride_ = stride;
+				if (data_) memset(data_, 0, bytes());
+		}
+
+		// change the shape keeping existing cells (new cells are zero); the
+		// block grows geometrically so appending rows or columns one at a
+		// time costs amortized O(1) per cell
+		void grow(int rows, int cols)
+		{
+				const size_t per_line = MATRIX_ALIGN / sizeof(double);
+				if ((size_t)cols > stride_ || (size_t)rows * stride_ > capacity_)
+				{
+						size_t stride = stride_, old_rows = stride_ ? capacity_ / stride_ : 0;
+						if ((size_t)cols > stride)
+								stride = (std::max((size_t)cols, stride_ * 2) + per_line - 1) / per_line * per_line;
+						size_t row_cap = std::max((size_t)rows, old_rows);
+						if ((size_t)rows > old_rows) row_cap = std::max((size_t)rows, old_rows * 2);
+						Matrix bigger;
+						bigger.reserve_exact(row_cap * stride);
+						bigger.rows_ = rows; bigger.cols_ = cols; bigger.stride_ = stride;
+						if (bigger.data_) memset(bigger.data_, 0, row_cap * stride * sizeof(double));
+						for (int i = 0; i < rows_ && i < rows; ++i)
+								memcpy(bigger[i], (*this)[i], std::min(cols_, cols) * sizeof(double));
+						swap(bigger);
+						return;
+				}
+				if (cols > cols_)
+						for (int i = 0; i < std::min(rows_, rows); ++i)
+								memset((*this)[i] + cols_, 0, (cols - cols_) * sizeof(double));
+				if (rows > rows_)
+						memset((*this)[rows_], 0, (size_t)(rows - rows_) * stride_ * sizeof(double));
+				rows_ = rows; cols_ = cols;
+		}
+
+		int rows() const { return rows_; }
+		int cols() const { return cols_; }
+		size_t stride() const { return stride_; }
+		bool empty() const { return rows_ == 0 || cols_ == 0; }
+
+		double *data() { return data_; }
+		const double *data() const { return data_; }
+		double *operator[](int i) { return data_ + i * stride_; }
+		const double *operator[](int i) const { return data_ + i * stride_; }
+
+		ColumnView col(int j) const { return ColumnView{data_ + j, stride_, rows_}; }
+
+private:
+		void reserve_exact(size_t need)
+		{
+				if (need <= capacity_) return;
+				void *p = nullptr;
+				if (posix_memalign(&p, MATRIX_ALIGN, need * sizeof(double)) != 0) throw std::bad_alloc();
+				free(data_);
+				data_ = (double *)p;
+				capacity_ = need;
+		}
+
+		size_t bytes() const { return (size_t)rows_ * stride_ * sizeof(double); }
+
+		double *data_ = nullptr;
+		int rows_ = 0, cols_ = 0;
+		size_t stride_ = 0, capacity_ = 0;
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "cache.h"
+#include "input.h"
+#include "modeldb.h"
+#include "parallel.h"
+
+using namespace std;
+
+static int key_cmp(const ModelRecord &a, const ModelRecord &b)
+{
+		int c = memcmp(a.device, b.device, MODELDB_DEVICE_LEN);
+		return c ? c : memcmp(a.pu, b.pu, MODELDB_PU_LEN);
+}
+
+int write_model_db(const char *path, vector<DbEntry> entries)
+{
+		vector<ModelRecord> records;
+		records.reserve(entries.size());
+		for (const DbEntry &e : entries)
+		{
+				if (e.device.size() >= MODELDB_DEVICE_LEN || e.pu.size() >= MODELDB_PU_LEN)
+				{
+						fprintf(stderr, "%s/%s: identifier too long (max %d/%d)\n", e.device.c_str(), e.pu.c_str(),
+						        MODELDB_DEVICE_LEN - 1, MODELDB_PU_LEN - 1);
+						return -1;
+				}
+				ModelRecord r = {};
+				memcpy(r.device, e.device.data(), e.device.size());
+				memcpy(r.pu, e.pu.data(), e.pu.size());
+				r.model = e.model;
+				records.push_back(r);
+		}
+		// stable sort keeps input order among duplicates, then keep the last one
+		stable_sort(records.begin(), records.end(),
+		            [](const ModelRecord &a, const ModelRecord &b) { return key_cmp(a, b) < 0; });
+		size_t out = 0;
+		for (size_t k = 0; k < records.size(); ++k)
+		{
+				if (k + 1 < records.size() && key_cmp(records[k], records[k+1]) == 0) continue;
+				records[out++] = records[k];
+		}
+		records.resize(out);
+
+		DbHeader h;
+		memset(&h, 0, sizeof(h));
+		memcpy(h.magic, MODELDB_MAGIC, sizeof(MODELDB_MAGIC));
+		h.version = MODELDB_VERSION;
+		h.record_size = sizeof(ModelRecord);
+		h.byte_order = 0x01020304;
+		h.count = records.size();
+
+		string tmp = string(path) + ".tmp";
+		FILE *fp = fopen(tmp.c_str(), "wb");
+		if (fp == NULL) { fprintf(stderr, "%s: cannot open output file\n", tmp.c_str()); return -1; }
+		bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+		          fwrite(records.data(), sizeof(ModelRecord), records.size(), fp) == records.size();
+		ok = (fclose(fp) == 0) && ok;
+		if (!ok || rename(tmp.c_str(), path) != 0)
+		{
+				fprintf(stderr, "%s: write failed\n", path);
+				remove(tmp.c_str());
+				return -1;
+		}
+		return 0;
+}
+
+// text model if the file parses as one, otherwise an input matrix to fit
+static int load_model(const string &path, PccsModel &model)
+{
+		FILE *fp = fopen(path.c_str(), "r");
+		if (fp == NULL) { fprintf(stderr, "%s: cannot open\n", path.c_str()); return -1; }
+		int r = read_model(fp, model);
+		fclose(fp);
+		if (r == 0) return 0;
+
+		Sweep sweep;
+		if (read_input(path.c_str(), sweep, nullptr, 1) != 0) return -1;
+		if (fit_cached(sweep, model, default_cache_dir()) != 0)
+		{
+				fprintf(stderr, "%s: no minor/normal region boundary found\n", path.c_str());
+				return -1;
+		}
+		return 0;
+}
+
+int export_model_db(const char *db_path, const char *manifest, unsigned threads)
+{
+		namespace fs = std::filesystem;
+		ifstream in(manifest);
+		if (!in) { fprintf(stderr, "%s: cannot open manifest\n", manifest); return -1; }
+
+		fs::path base = fs::path(manifest).parent_path();
+		vector<DbEntry> entries;
+		vector<string> paths;
+		string line;
+		int lineno = 0;
+		while (getline(in, line))
+		{
+				++lineno;
+				istringstream fields(line);
+				DbEntry e;
+				string path;
+				if (!(fields >> e.device) || e.device[0] == '#') continue;
+				if (!(fields >> e.pu >> path))
+				{
+						fprintf(stderr, "%s:%d: expected \"device pu path\"\n", manifest, lineno);
+						return -1;
+				}
+				fs::path p = path;
+				paths.push_back(p.is_absolute() ? path : (base / p).string());
+				entries.push_back(e);
+		}
+
+		vector<int> status(entries.size());
+		parallel_for(entries.size(), [&](size_t k, unsigned) {
+				status[k] = load_model(paths[k], entries[k].model);
+		}, threads);
+		for (int s : status)
+				if (s != 0) return -1;
+		return write_model_db(db_path, entries);
+}
+
+int ModelDb::open(const char *path)
+{
+		records_ = nullptr; count_ = 0;
+		if (!file_.open(path)) { fprintf(stderr, "%s: cannot open model database\n", path); return -1; }
+
+		const DbHeader *h = (const DbHeader *)file_.data;
+		if (file_.size < sizeof(DbHeader) || memcmp(h->magic, MODELDB_MAGIC, sizeof(MODELDB_MAGIC)) != 0)
+		{
+				fprintf(stderr, "%s: not a model database\n", path);
+				return -1;
+		}
+		if (h->version != MODELDB_VERSION || h->record_size != sizeof(ModelRecord) || h->byte_order != 0x01020304)
+		{
+				fprintf(stderr, "%s: unsupported model database version %u\n", path, h->version);
+				return -1;
+		}
+		if (h->count > (file_.size - sizeof(DbHeader)) / sizeof(ModelRecord))
+		{
+				fprintf(stderr, "%s: truncated model database\n", path);
+				return -1;
+		}
+		records_ = (const ModelRecord *)(file_.data + sizeof(DbHeader));
+		count_ = h->count;
+		return 0;
+}
+
+const ModelRecord *ModelDb::find(const char *device, const char *pu) const
+{
+		size_t dl = strlen(device), pl = strlen(pu);
+		if (dl >= MODELDB_DEVICE_LEN || pl >= MODELDB_PU_LEN) return nullptr;
+		ModelRecord key = {};
+		memcpy(key.device, device, dl);
+		memcpy(key.pu, pu, pl);
+
+		const ModelRecord *it = lower_bound(records_, records_ + count_, key,
+		                                    [](const ModelRecord &a, const ModelRecord &b) { return key_cmp(a, b) < 0; });
+		return it != records_ + count_ && key_cmp(*it, key) == 0 ? it : nullptr;
+}
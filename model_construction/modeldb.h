@@ -0,0 +1,76 @@
+#ifndef MODELDB_H
+#define MODELDB_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "pccs.h"
+
+// binary model database, version 1, native byte order:
+//   DbHeader, then `count` ModelRecords sorted by (device, pu)
+// identifiers are NUL-padded, so memcmp over the fixed fields sorts them
+// like strcmp and a lookup is a binary search over the mapped file
+
+#define MODELDB_MAGIC "PCCSMDB"
+#define MODELDB_VERSION 1
+#define MODELDB_DEVICE_LEN 48
+#define MODELDB_PU_LEN 16
+
+struct DbHeader
+{
+		char magic[8];
+		uint32_t version;
+		uint32_t record_size;
+		uint32_t byte_order;          // 0x01020304 as written
+		uint32_t reserved;
+		uint64_t count;
+};
+
+struct ModelRecord
+{
+		char device[MODELDB_DEVICE_LEN];
+		char pu[MODELDB_PU_LEN];
+		PccsModel model;
+};
+
+static_assert(sizeof(DbHeader) == 32, "DbHeader layout");
+static_assert(sizeof(ModelRecord) == 112, "ModelRecord layout");
+
+struct DbEntry
+{
+		std::string device, pu;
+		PccsModel model;
+};
+
+// write entries sorted by (device, pu); a later duplicate replaces an earlier
+// one. The file is written beside `path` and renamed into place.
+// returns 0, or -1 (message on stderr)
+int write_model_db(const char *path, std::vector<DbEntry> entries);
+
+// build a database from a manifest of "device pu path" lines ('#' comments,
+// paths relative to the manifest); each path is either a six-line model
+// written by ./main or an input matrix, which is fitted on the spot.
+// returns 0, or -1 if any line fails (message on stderr)
+int export_model_db(const char *db_path, const char *manifest, unsigned threads = 0);
+
+class ModelDb
+{
+public:
+		// map and validate a database; returns 0, or -1 (message on stderr)
+		int open(const char *path);
+
+		size_t size() const { return count_; }
+		const ModelRecord &operator[](size_t k) const { return records_[k]; }
+
+		// nullptr when the pair is absent
+		const ModelRecord *find(const char *device, const char *pu) const;
+
+private:
+		MappedFile file_;
+		const ModelRecord *records_ = nullptr;
+		size_t count_ = 0;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// worker count for "use the whole machine"
+inline unsigned default_threads()
+{
+		unsigned n = std::thread::hardware_concurrency();
+		return n ? n : 1;
+}
+
+// run fn(index, worker) for index in [0, count) on up to `threads` workers
+// (0 = default_threads()); indices are handed out one at a time, so uneven
+// items balance themselves, and worker < threads can select per-thread state
+template <class F>
+void parallel_for(size_t count, F fn, unsigned threads = 0)
+{
+		if (threads == 0) threads = default_threads();
+		if (threads > count) threads = count ? count : 1;
+		std::atomic<size_t> next(0);
+		auto run = [&](unsigned worker) {
+				for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count; )
+						fn(i, worker);
+		};
+		std::vector<std::thread> pool;
+		for (unsigned t = 1; t < threads; ++t) pool.emplace_back(run, t);
+		run(0);
+		for (auto &th : pool) th.join();
+}
+
+#endif
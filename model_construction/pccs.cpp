@@ -0,0 +1,193 @@
+#include <math.h>
+#include <algorithm>
+
+#include "pccs.h"
+
+using namespace std;
+
+double relative_speed(const Sweep &sweep, Matrix &speed)
+{
+		int n = sweep.standaloneBW.size(), m = sweep.externalBW.size();
+		double PBW = 0;
+		speed.resize(n, m);
+		for (int i = 0; i < n; ++i)
+		{
+				const double *bw = sweep.achievedBW[i];
+				double *s = speed[i];
+				for (int j = 0; j < m; ++j)
+				{
+						PBW = max(PBW, bw[j]);
+						s[j] = bw[j]/sweep.standaloneBW[i]*100;
+				}
+		}
+		return PBW;
+}
+
+int find_regions(const Sweep &sweep, const Matrix &speed, double PBW, Regions &regions, PccsModel &model,
+                 const FitThresholds &thresholds)
+{
+		const vector<double> &standaloneBW = sweep.standaloneBW;
+		int i, k, n = standaloneBW.size(), m = sweep.externalBW.size();
+		model = PccsModel();
+		regions = Regions();
+		regions.thresholds = thresholds;
+		if (n == 0 || m == 0) return -1;
+
+		ColumnView last_col = speed.col(m-1);
+		ColumnView first_col = speed.col(0);
+
+		// determine the boundary between minor region and normal region
+		// first branch is for no minor region case
+		// second branch is to find the first kernel whose reduction at the
+		// heaviest external demand is twice that of the smallest kernel
+		if (last_col[0] < thresholds.minor) {model.MRMC = -1; model.normal_BW = 0; return 0;}
+
+		double reduction = min(100 - last_col[0], 95.0);
+		for (i = 0; i < n; ++i)
+		{
+				if (reduction * thresholds.normal_factor < (100-last_col[i])) break;
+		}
+		if (i == 0) return -1;
+		regions.minor = true;
+		regions.reduction = reduction;
+		regions.normal_boundary = i; model.normal_BW = standaloneBW[i-1]; model.MRMC = 100- last_col[i-1];
+
+		for (k = i; k < n; ++k)
+		{
+				if ((100-first_col[k] >= reduction * thresholds.normal_factor)) break;
+		}
+		if (k == n) { model.intensive_BW=PBW; regions.intensive_boundary=n;}
+		else { model.intensive_BW=standaloneBW[k]; regions.intensive_boundary = k;}
+		return 0;
+}
+
+void fit_parameters(const Sweep &sweep, const Matrix &speed, const Regions &regions, PccsModel &model,
+                    FitWorkspace *ws)
+{
+		const vector<double> &standaloneBW = sweep.standaloneBW, &externalBW = sweep.externalBW;
+		int i, j, m = externalBW.size();
+		int normal_boundary = regions.normal_boundary, intensive_boundary = regions.intensive_boundary;
+		double reduction = regions.reduction;
+		const FitThresholds &thresholds = regions.thresholds;
+		if (!regions.minor) return;
+
+		if (ws)
+		{
+				ws->onset_column.clear();
+				ws->onset_demand.clear();
+				ws->balance_column.clear();
+		}
+
+		// TBWDC: average total demand at which each normal kernel starts to suffer
+		double sum = 0;
+		for (i = normal_boundary; i < intensive_boundary; ++i)
+		{
+				const double *s = speed[i];
+				for (j = 0; j < m; ++j)
+				{
+						if ((100-s[j]) >= reduction * thresholds.normal_factor) break;
+				}
+				double demand = standaloneBW[i]+externalBW[min(j, m-1)];
+				sum = sum + demand;
+				if (ws) { ws->onset_column.push_back(j); ws->onset_demand.push_back(demand); }
+		}
+		model.TBWDC = sum/(intensive_boundary-normal_boundary);
+
+		// CBP: where the per-kernel slope past TBWDC flattens out
+		vector <int> local;
+		vector <int> &balancepoints = ws ? ws->balancepoints : local;
+		balancepoints.assign(m+2,0);
+		for (i = normal_boundary; i < intensive_boundary; ++i)
+		{
+				const double *s = speed[i];
+				double sum = 0.0, cur; int cnt = 0;
+				for (j = 1; j < m; ++j)
+				{
+						if (standaloneBW[i] + externalBW[j] >= model.TBWDC)
+						{
+								cur = (s[j-1]-s[j])/(externalBW[j]-externalBW[j-1]);
+								if (cnt != 0) {
+										if (cur * thresholds.balance_factor < sum/cnt)  {break;}
+								}
+								sum+= cur; cnt++;
+						}
+				}
+				balancepoints[j+1]++;
+				if (ws) ws->balance_column.push_back(j);
+		}
+		sum = 0.0;
+		for (j = 1; j < m; ++j)
+				sum+=balancepoints[j]*externalBW[j];
+		model.CBP=sum/(intensive_boundary - normal_boundary+1);
+
+		// rate_i: mean speed loss per unit of external BW below CBP
+		double rate_sum=0.0; int rate_cnt = 0;
+		for (i = normal_boundary; i < intensive_boundary; ++i)
+		{
+				const double *s = speed[i];
+				for (j = 1; j < m; ++j)
+						if (externalBW[j]<=model.CBP)
+						{
+								rate_sum+=(s[j-1]-s[j])/(externalBW[j]-externalBW[j-1]);
+								rate_cnt++;
+						}
+		}
+		model.rate_i = rate_sum/rate_cnt;
+}
+
+int fit(const Sweep &sweep, const Matrix &speed, double PBW, PccsModel &model,
+        FitWorkspace *ws, const FitThresholds &thresholds)
+{
+		Regions regions;
+		int status = find_regions(sweep, speed, PBW, regions, model, thresholds);
+		if (status == 0) fit_parameters(sweep, speed, regions, model, ws);
+		return status;
+}
+
+
+int fit(const Sweep &sweep, PccsModel &model)
+{
+		Matrix speed;
+		double PBW = relative_speed(sweep, speed);
+		return fit(sweep, speed, PBW, model);
+}
+
+double predict_relative_speed(const PccsModel &model, double own_bw, double external_bw)
+{
+		double contended, loss;
+		if (own_bw < model.normal_BW)
+		{
+				contended = model.CBP > 0 ? min(external_bw / model.CBP, 1.0) : 1.0;
+				loss = model.MRMC * contended;
+		}
+		else
+		{
+				double onset = own_bw < model.intensive_BW ? max(model.TBWDC - own_bw, 0.0) : 0.0;
+				contended = max(min(external_bw, model.CBP) - onset, 0.0);
+				loss = model.rate_i * contended;
+		}
+		return min(max(100 - loss, 0.0), 100.0);
+}
+
+double predict_slowdown(const PccsModel &model, double own_bw, double external_bw)
+{
+		return 100 / predict_relative_speed(model, own_bw, external_bw);
+}
+
+void write_model(FILE *fp, const PccsModel &model)
+{
+		fprintf(fp, "Normal BW %lf\n", model.normal_BW);
+		fprintf(fp, "intensive BW %lf\n", model.intensive_BW);
+		fprintf(fp, "MRMC %lf\n", model.MRMC);
+		fprintf(fp, "TBWDC %lf\n", model.TBWDC);
+		fprintf(fp, "CBP %lf\n", model.CBP);
+		fprintf(fp, "rate_i %lf\n", model.rate_i);
+}
+
+int read_model(FILE *fp, PccsModel &model)
+{
+		int got = fscanf(fp, " Normal BW %lf intensive BW %lf MRMC %lf TBWDC %lf CBP %lf rate_i %lf",
+		                 &model.normal_BW, &model.intensive_BW, &model.MRMC,
+		                 &model.TBWDC, &model.CBP, &model.rate_i);
+		return got == 6 ? 0 : -1;
+}
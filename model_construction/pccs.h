@@ -0,0 +1,92 @@
+#ifndef PCCS_H
+#define PCCS_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "matrix.h"
+
+// one characterization sweep of a target PU: n kernels of increasing
+// standalone BW, each co-run against m increasing external BW demands
+struct Sweep
+{
+		std::vector<double> standaloneBW;      // n
+		std::vector<double> externalBW;        // m
+		Matrix achievedBW;                     // n x m
+};
+
+// the six PCCS parameters; MRMC is -1 when the PU has no minor region
+struct PccsModel
+{
+		double normal_BW = 0;
+		double intensive_BW = 0;
+		double MRMC = 0;
+		double TBWDC = 0;
+		double CBP = 0;
+		double rate_i = 0;
+};
+
+// speed[i][j] = achievedBW[i][j] / standaloneBW[i] * 100; returns the peak achieved BW
+double relative_speed(const Sweep &sweep, Matrix &speed);
+
+// scratch space for repeated fits (bootstrap, searches); fit() grows it on
+// first use and after that runs without allocating. After a fit with a minor
+// region it also holds what fit_parameters derived TBWDC and CBP from
+struct FitWorkspace
+{
+		Matrix speed;
+		std::vector<int> balancepoints;        // CBP histogram, m + 2 buckets
+		std::vector<int> onset_column;         // per normal kernel: first column past the reduction cut-off (m if none)
+		std::vector<double> onset_demand;      // per normal kernel: its TBWDC contribution
+		std::vector<int> balance_column;       // per normal kernel: column its slope flattened at (m if none)
+};
+
+// the fitter's cut-offs; the defaults are the ones the model was published with
+struct FitThresholds
+{
+		double minor = 80;             // no minor region if the smallest kernel keeps this much speed
+		double normal_factor = 2;      // normal/intensive kernels lose this many times the minor reduction
+		double balance_factor = 3;     // a kernel's CBP is where its slope drops below mean / this
+};
+
+// where the regions split, in kernel (row) indices
+struct Regions
+{
+		bool minor = false;            // false: no minor region, nothing else to fit
+		double reduction = 0;          // smallest kernel's reduction at the heaviest demand
+		int normal_boundary = 0;       // first normal-region kernel
+		int intensive_boundary = 0;    // first intensive-region kernel, n if none
+		FitThresholds thresholds;      // the cut-offs the regions were found with
+};
+
+// the two halves of fit(): region detection sets normal_BW, intensive_BW and
+// MRMC (returns 0, or -1 as fit()); fit_parameters adds TBWDC, CBP and rate_i
+int find_regions(const Sweep &sweep, const Matrix &speed, double PBW, Regions &regions, PccsModel &model,
+                 const FitThresholds &thresholds = FitThresholds());
+void fit_parameters(const Sweep &sweep, const Matrix &speed, const Regions &regions, PccsModel &model,
+                    FitWorkspace *ws = nullptr);
+
+// fit a model from a sweep and its relative speed matrix
+// returns 0, or -1 when the sweep has no usable minor/normal boundary
+int fit(const Sweep &sweep, const Matrix &speed, double PBW, PccsModel &model,
+        FitWorkspace *ws = nullptr, const FitThresholds &thresholds = FitThresholds());
+int fit(const Sweep &sweep, PccsModel &model);
+
+// predicted relative speed in percent of a kernel that achieves own_bw when
+// run alone, while the other PUs demand external_bw:
+//   minor     (own_bw <  normal_BW):    loses up to MRMC, reached at CBP
+//   normal    (own_bw <  intensive_BW): no loss until own_bw + external_bw
+//                                       reaches TBWDC, then rate_i per GB/s
+//                                       of external BW up to CBP
+//   intensive (own_bw >= intensive_BW): rate_i per GB/s from 0 up to CBP
+double predict_relative_speed(const PccsModel &model, double own_bw, double external_bw);
+
+// co-run time / standalone time, i.e. 100 / relative speed
+double predict_slowdown(const PccsModel &model, double own_bw, double external_bw);
+
+// the six-line text format written by ./main; read_model returns 0, or -1
+// if the stream does not hold that format
+void write_model(FILE *fp, const PccsModel &model);
+int read_model(FILE *fp, PccsModel &model);
+
+#endif
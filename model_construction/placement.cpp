@@ -0,0 +1,364 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+#include "corun.h"
+#include "placement.h"
+
+using namespace std;
+
+int read_task_graph(const char *path, TaskGraph &graph)
+{
+		FILE *fp = fopen(path, "r");
+		if (fp == NULL) { fprintf(stderr, "%s: cannot open\n", path); return -1; }
+		graph = TaskGraph();
+		unordered_map<string, int> index;
+		char line[65536];
+		int lineno = 0, status = 0;
+		while (status == 0 && fgets(line, sizeof line, fp))
+		{
+				++lineno;
+				char *hash = strchr(line, '#');
+				if (hash) *hash = 0;
+				const char *sep = " \t\r\n";
+				char *word = strtok(line, sep);
+				if (word == NULL) continue;
+				if (strcmp(word, "pus") == 0 && graph.tasks.empty())
+				{
+						graph.pus.clear();
+						for (char *tok; (tok = strtok(NULL, sep)); ) graph.pus.push_back(tok);
+						continue;
+				}
+				char *name = strcmp(word, "task") == 0 ? strtok(NULL, sep) : NULL;
+				if (name == NULL || graph.pus.empty() || index.count(name)) { status = -1; break; }
+
+				PlaceTask task;
+				task.name = name;
+				for (size_t p = 0; p < graph.pus.size() && status == 0; ++p)
+				{
+						char *t = strtok(NULL, sep), *b = strtok(NULL, sep);
+						if (t == NULL || b == NULL) status = -1;
+						else if (strcmp(t, "-") == 0) { task.time.push_back(-1); task.bw.push_back(0); }
+						else { task.time.push_back(atof(t)); task.bw.push_back(atof(b)); }
+				}
+				char *tok = status == 0 ? strtok(NULL, sep) : NULL;
+				if (tok && strcmp(tok, "after") != 0) status = -1;
+				while (status == 0 && tok && (tok = strtok(NULL, sep)))
+				{
+						auto it = index.find(tok);
+						if (it == index.end()) status = -1;
+						else task.deps.push_back(it->second);
+				}
+				index[task.name] = graph.tasks.size();
+				graph.tasks.push_back(task);
+		}
+		fclose(fp);
+		if (status != 0) fprintf(stderr, "%s:%d: expected 'pus <names>' once, then 'task <name> <time> <bw> ... "
+		                         "[after <earlier task> ...]'\n", path, lineno);
+		return status;
+}
+
+// relative speed (as a fraction) of each PU's running task, solved once per
+// running set (task index per PU, -1 idle)
+class RateMemo
+{
+public:
+		const vector<double> &rates(const TaskGraph &graph, const vector<PccsModel> &models,
+		                            const vector<int> &running);
+		long misses = 0;
+
+private:
+		map<vector<int>, vector<double> > memo_;
+		vector<CorunPu> set_;
+		vector<int> owner_;
+		CorunResult result_;
+};
+
+const vector<double> &RateMemo::rates(const TaskGraph &graph, const vector<PccsModel> &models,
+                                      const vector<int> &running)
+{
+		auto it = memo_.find(running);
+		if (it != memo_.end()) return it->second;
+		set_.clear(); owner_.clear();
+		for (size_t p = 0; p < running.size(); ++p)
+				if (running[p] >= 0)
+				{
+						CorunPu pu;
+						pu.model = models[p];
+						pu.standalone_bw = graph.tasks[running[p]].bw[p];
+						set_.push_back(pu);
+						owner_.push_back(p);
+				}
+		vector<double> rate(running.size(), 0);
+		predict_corun(set_.data(), set_.size(), result_);
+		for (size_t k = 0; k < set_.size(); ++k)
+				rate[owner_[k]] = max(result_.relative_speed[k] / 100, 1e-9);
+		++misses;
+		return memo_.emplace(running, rate).first->second;
+}
+
+void simulate_placement(const TaskGraph &graph, const vector<PccsModel> &models, Placement &placement)
+{
+		int T = graph.tasks.size(), P = graph.pus.size();
+		placement.start.resize(T);
+		placement.finish.assign(T, NAN);
+		placement.slowdown.assign(T, NAN);
+		placement.makespan = 0;
+
+		// every PU's tasks in start order
+		vector<vector<int> > queue(P);
+		for (int t = 0; t < T; ++t) queue[placement.pu[t]].push_back(t);
+		for (vector<int> &q : queue)
+				stable_sort(q.begin(), q.end(), [&](int a, int b) { return placement.start[a] < placement.start[b]; });
+
+		vector<int> waiting(T), running(P, -1);
+		vector<size_t> head(P, 0);
+		vector<vector<int> > succ(T);
+		for (int t = 0; t < T; ++t)
+		{
+				waiting[t] = graph.tasks[t].deps.size();
+				for (int d : graph.tasks[t].deps) succ[d].push_back(t);
+		}
+		vector<double> remaining(T);
+		for (int t = 0; t < T; ++t) remaining[t] = max(graph.tasks[t].time[placement.pu[t]], 0.0);
+
+		RateMemo memo;
+		double now = 0;
+		int finished = 0;
+		while (finished < T)
+		{
+				for (int p = 0; p < P; ++p)
+				{
+						if (running[p] >= 0 || head[p] == queue[p].size()) continue;
+						int t = queue[p][head[p]];
+						if (waiting[t] != 0) continue;
+						running[p] = t;
+						++head[p];
+						placement.start[t] = now;
+				}
+				const vector<double> &rate = memo.rates(graph, models, running);
+
+				// a PU order that waits on a task queued behind it never resolves
+				double dt = INFINITY;
+				for (int p = 0; p < P; ++p)
+						if (running[p] >= 0) dt = min(dt, remaining[running[p]] / rate[p]);
+				if (dt == INFINITY) { placement.makespan = INFINITY; return; }
+
+				now += dt;
+				for (int p = 0; p < P; ++p)
+				{
+						int t = running[p];
+						if (t < 0) continue;
+						remaining[t] -= rate[p] * dt;
+						if (remaining[t] > 1e-12 * max(graph.tasks[t].time[p], 1.0)) continue;
+						running[p] = -1;
+						placement.finish[t] = now;
+						double alone = graph.tasks[t].time[p];
+						placement.slowdown[t] = alone > 0 ? (now - placement.start[t]) / alone : 1;
+						for (int s : succ[t]) --waiting[s];
+						++finished;
+				}
+		}
+		placement.makespan = now;
+		placement.evaluations = memo.misses;
+}
+
+// a partially run schedule: tasks are started one at a time, and the clock
+// only moves forward when no idle PU can start a ready task
+struct Partial
+{
+		double now = 0;
+		vector<int> pu, waiting;           // per task; waiting counts unfinished dependencies
+		vector<double> start, finish, remaining;
+		vector<int> running;               // per PU, -1 idle
+		int started = 0, finished = 0;
+		double unstarted_work = 0;         // sum of fastest standalone times not yet started
+		double score = 0;
+};
+
+struct Search
+{
+		const TaskGraph &graph;
+		const vector<PccsModel> &models;
+		vector<vector<int> > succ;
+		vector<double> fastest, rank, tail;     // tail: longest path after the task
+		RateMemo memo;
+
+		Search(const TaskGraph &g, const vector<PccsModel> &m) : graph(g), models(m) {}
+
+		bool fits_idle(const Partial &s, int t) const
+		{
+				for (size_t p = 0; p < graph.pus.size(); ++p)
+						if (s.running[p] < 0 && graph.tasks[t].time[p] >= 0) return true;
+				return false;
+		}
+
+		bool can_start(const Partial &s) const
+		{
+				for (int t = 0; t < (int)graph.tasks.size(); ++t)
+						if (s.pu[t] < 0 && s.waiting[t] == 0 && fits_idle(s, t)) return true;
+				return false;
+		}
+
+		// run until the next completion
+		void advance(Partial &s)
+		{
+				int P = graph.pus.size();
+				const vector<double> &rate = memo.rates(graph, models, s.running);
+				double dt = INFINITY;
+				for (int p = 0; p < P; ++p)
+						if (s.running[p] >= 0) dt = min(dt, s.remaining[s.running[p]] / rate[p]);
+				s.now += dt;
+				for (int p = 0; p < P; ++p)
+				{
+						int t = s.running[p];
+						if (t < 0) continue;
+						s.remaining[t] -= rate[p] * dt;
+						if (s.remaining[t] > 1e-12 * max(graph.tasks[t].time[p], 1.0)) continue;
+						s.running[p] = -1;
+						s.finish[t] = s.now;
+						++s.finished;
+						for (int u : succ[t]) --s.waiting[u];
+				}
+		}
+
+		// lower bound on the makespan if t starts on p now: the running tasks
+		// at their current speeds plus their longest tails, the longest path
+		// from any other ready task, and the remaining work spread over all PUs
+		double bound(Partial &s, int t, int p)
+		{
+				int P = graph.pus.size();
+				s.running[p] = t;
+				s.remaining[t] = graph.tasks[t].time[p];
+				const vector<double> &rate = memo.rates(graph, models, s.running);
+				double end = s.now, work = s.unstarted_work - fastest[t];
+				for (int q = 0; q < P; ++q)
+				{
+						int u = s.running[q];
+						if (u < 0) continue;
+						end = max(end, s.now + s.remaining[u] / rate[q] + tail[u]);
+						work += s.remaining[u];
+				}
+				for (int u = 0; u < (int)graph.tasks.size(); ++u)
+						if (u != t && s.pu[u] < 0 && s.waiting[u] == 0) end = max(end, s.now + rank[u]);
+				s.running[p] = -1;
+				return max(end, s.now + work / P);
+		}
+};
+
+int place_tasks(const TaskGraph &graph, const vector<PccsModel> &models, Placement &placement,
+                const PlaceOptions &options)
+{
+		int T = graph.tasks.size(), P = graph.pus.size();
+		Search search(graph, models);
+		search.succ.resize(T);
+		search.fastest.assign(T, INFINITY);
+		for (int t = 0; t < T; ++t)
+		{
+				for (int p = 0; p < P; ++p)
+						if (graph.tasks[t].time[p] >= 0) search.fastest[t] = min(search.fastest[t], graph.tasks[t].time[p]);
+				if (search.fastest[t] == INFINITY)
+				{
+						fprintf(stderr, "%s: runs on no PU\n", graph.tasks[t].name.c_str());
+						return -1;
+				}
+				for (int d : graph.tasks[t].deps) search.succ[d].push_back(t);
+		}
+		// longest standalone path from each task to the end, fastest PU each
+		search.rank.assign(T, 0);
+		search.tail.assign(T, 0);
+		for (int t = T - 1; t >= 0; --t)
+		{
+				for (int s : search.succ[t]) search.tail[t] = max(search.tail[t], search.rank[s]);
+				search.rank[t] = search.fastest[t] + search.tail[t];
+		}
+
+		Partial root;
+		root.pu.assign(T, -1);
+		root.start.assign(T, 0); root.finish.assign(T, 0); root.remaining.assign(T, 0);
+		root.running.assign(P, -1);
+		root.waiting.resize(T);
+		for (int t = 0; t < T; ++t)
+		{
+				root.waiting[t] = graph.tasks[t].deps.size();
+				root.unstarted_work += search.fastest[t];
+		}
+
+		// each step starts one more task in every surviving schedule; children
+		// are scored first and only the best `beam` are copied
+		struct Child { double score; int parent, task, pu; };
+		vector<Partial> beam(1, root), next;
+		vector<Child> children;
+		vector<int> ready;
+		for (int step = 0; step < T; ++step)
+		{
+				children.clear();
+				for (size_t b = 0; b < beam.size(); ++b)
+				{
+						Partial &s = beam[b];
+						while (!search.can_start(s)) search.advance(s);
+						ready.clear();
+						for (int t = 0; t < T; ++t)
+								if (s.pu[t] < 0 && s.waiting[t] == 0 && search.fits_idle(s, t)) ready.push_back(t);
+						// only the ready tasks with the longest paths are worth branching on
+						size_t keep = min(ready.size(), (size_t)max(options.branch, 1));
+						partial_sort(ready.begin(), ready.begin() + keep, ready.end(),
+						             [&](int a, int c) { return search.rank[a] > search.rank[c]; });
+						for (size_t r = 0; r < keep; ++r)
+								for (int p = 0; p < P; ++p)
+										if (s.running[p] < 0 && graph.tasks[ready[r]].time[p] >= 0)
+										{
+												Child c = {search.bound(s, ready[r], p), (int)b, ready[r], p};
+												children.push_back(c);
+										}
+				}
+				size_t keep = min(children.size(), (size_t)max(options.beam, 1));
+				partial_sort(children.begin(), children.begin() + keep, children.end(),
+				             [](const Child &a, const Child &c) { return a.score < c.score; });
+				next.clear();
+				for (size_t c = 0; c < keep; ++c)
+				{
+						next.push_back(beam[children[c].parent]);
+						Partial &s = next.back();
+						int t = children[c].task, p = children[c].pu;
+						s.pu[t] = p;
+						s.start[t] = s.now;
+						s.remaining[t] = graph.tasks[t].time[p];
+						s.running[p] = t;
+						s.unstarted_work -= search.fastest[t];
+						++s.started;
+				}
+				beam.swap(next);
+		}
+
+		Partial *best = nullptr;
+		for (Partial &s : beam)
+		{
+				while (s.finished < T) search.advance(s);
+				if (best == nullptr || s.now < best->now) best = &s;
+		}
+		placement.pu = best->pu;
+		placement.start = best->start;
+		placement.finish = best->finish;
+		placement.slowdown.resize(T);
+		for (int t = 0; t < T; ++t)
+		{
+				double alone = graph.tasks[t].time[best->pu[t]];
+				placement.slowdown[t] = alone > 0 ? (best->finish[t] - best->start[t]) / alone : 1;
+		}
+		placement.makespan = best->now;
+		placement.evaluations = search.memo.misses;
+		return 0;
+}
+
+void write_placement(FILE *fp, const TaskGraph &graph, const Placement &placement)
+{
+		fprintf(fp, "# task pu start finish slowdown\n");
+		for (size_t t = 0; t < graph.tasks.size(); ++t)
+				fprintf(fp, "%s %s %lf %lf %lf\n", graph.tasks[t].name.c_str(), graph.pus[placement.pu[t]].c_str(),
+				        placement.start[t], placement.finish[t], placement.slowdown[t]);
+		fprintf(fp, "makespan %lf\n", placement.makespan);
+}
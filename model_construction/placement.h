@@ -0,0 +1,70 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "pccs.h"
+
+// one pipeline stage: its standalone run time and BW on each PU of the
+// graph (time < 0 where it cannot run) and the stages it waits for
+struct PlaceTask
+{
+		std::string name;
+		std::vector<double> time, bw;     // per PU
+		std::vector<int> deps;            // indices of earlier tasks
+};
+
+struct TaskGraph
+{
+		std::vector<std::string> pus;
+		std::vector<PlaceTask> tasks;
+};
+
+// text format, '#' comments:
+//   pus CPU GPU NPU
+//   task <name> <time> <bw> ... one pair per PU, "- -" where it cannot run ... [after <name> ...]
+// a task may only wait for tasks listed above it, so the graph is acyclic.
+// returns 0, or -1 (message on stderr)
+int read_task_graph(const char *path, TaskGraph &graph);
+
+struct PlaceOptions
+{
+		int beam = 16;       // partial schedules kept per step
+		int branch = 4;      // ready tasks (longest path first) tried per schedule and step
+};
+
+// per-task schedule, indexed like graph.tasks
+struct Placement
+{
+		std::vector<int> pu;
+		std::vector<double> start, finish;
+		std::vector<double> slowdown;     // (finish - start) / standalone time
+		double makespan = 0;
+		long evaluations = 0;             // co-run solves during simulation (memo misses)
+};
+
+// run a placement: every PU works through its tasks in order of
+// placement.start, each task starting once its PU is free and its
+// dependencies are done. While tasks overlap they progress at the speed
+// predict_corun() gives for the running set; solves are memoized on that set.
+// models[p] belongs to graph.pus[p]. Fills start, finish, slowdown, makespan.
+void simulate_placement(const TaskGraph &graph, const std::vector<PccsModel> &models, Placement &placement);
+
+// beam search over schedules. Every step starts one more task in each
+// surviving schedule, on an idle PU, choosing among the ready tasks with the
+// longest standalone path to the end; the clock of a schedule only moves,
+// with full co-run contention, when none of its idle PUs can start anything.
+// Candidates are ranked by a lower bound on their makespan (running tasks at
+// their current speed plus their longest tails, and the remaining work
+// spread over all PUs). Co-run solves are memoized on the running set and
+// shared by all schedules. The result replays identically in
+// simulate_placement(). returns 0, or -1 if some task cannot run on any PU
+int place_tasks(const TaskGraph &graph, const std::vector<PccsModel> &models, Placement &placement,
+                const PlaceOptions &options = PlaceOptions());
+
+// "task pu start finish slowdown" per task, then the makespan
+void write_placement(FILE *fp, const TaskGraph &graph, const Placement &placement);
+
+#endif
@@ -0,0 +1,175 @@
+#include <math.h>
+#include <algorithm>
+
+#include "planner.h"
+
+using namespace std;
+
+Planner::Planner(const vector<double> &standaloneBW, const vector<double> &externalBW,
+                 const PlannerOptions &options)
+		: options_(options)
+{
+		sweep_.standaloneBW = standaloneBW;
+		sweep_.externalBW = externalBW;
+		sweep_.achievedBW.resize(standaloneBW.size(), externalBW.size());
+		speed_.resize(standaloneBW.size(), externalBW.size());
+		measured_.assign(total(), 0);
+}
+
+int Planner::budget_left() const
+{
+		int budget = (int)(options_.budget * total());
+		return max(budget - measured_count_, 0);
+}
+
+vector<pair<int, int> > Planner::next()
+{
+		int n = sweep_.standaloneBW.size(), m = sweep_.externalBW.size();
+		pending_.clear();
+		if (!seeded_)
+		{
+				seeded_ = true;
+				for (int i = 0; i < n; ++i)
+						for (int j : {0, m-1})
+								if (!measured_[i*m + j] && (j == 0 || m > 1)) pending_.push_back({i, j});
+				if (!pending_.empty()) return pending_;
+		}
+		if (done()) return pending_;
+
+		const vector<double> &sa = sweep_.standaloneBW, &ext = sweep_.externalBW;
+		const PccsModel &p = model_;
+		double span = max(ext[m-1] - ext[0], 1e-9), h = span / max(m-1, 1);
+		vector<pair<double, int> > scored;
+		for (int i = 0; i < n; ++i)
+		{
+				bool normal = i >= normal_lo_ - 1 && i <= normal_hi_;
+				int left = -1;
+				for (int j = 0; j < m; ++j)
+				{
+						if (measured_[i*m + j]) { left = j; continue; }
+						int right = j + 1;
+						while (right < m && !measured_[i*m + right]) ++right;
+						double lo = left >= 0 ? ext[left] : ext[0], hi = right < m ? ext[right] : ext[m-1];
+						// distance to the nearest measurement, so gaps are bisected
+						double score = 2 * min(ext[j] - lo, hi - ext[j]) / span;
+						if (normal)
+						{
+								double d1 = (sa[i] + ext[j] - p.TBWDC) / h, d2 = (ext[j] - p.CBP) / h;
+								double weight = 1;
+								if (isfinite(d1)) weight += 2 * exp(-d1 * d1);
+								if (isfinite(d2)) weight += 2 * exp(-d2 * d2);
+								if (ext[j] <= p.CBP) weight += 1;
+								score *= weight;
+						}
+						// cells that may move a crossing or balance point come first
+						if ((j > cross_lo_[i] && j < cross_hi_[i]) || (j > bal_lo_[i] && j < bal_hi_[i])) score += 100;
+						if (status_ == 0)
+						{
+								double miss = fabs(predict_relative_speed(p, sa[i], ext[j]) - speed_[i][j]) / 100;
+								if (isfinite(miss)) score += miss;
+						}
+						scored.push_back({-score, i*m + j});
+				}
+		}
+		size_t take = min((size_t)max(options_.per_round, 1), min(scored.size(), (size_t)budget_left()));
+		partial_sort(scored.begin(), scored.begin() + take, scored.end());
+		for (size_t k = 0; k < take; ++k)
+				pending_.push_back({scored[k].second / m, scored[k].second % m});
+		return pending_;
+}
+
+void Planner::record(int i, int j, double achieved)
+{
+		int m = sweep_.externalBW.size();
+		if (!measured_[i*m + j])
+		{
+				measured_[i*m + j] = 1;
+				measured_count_++;
+				history_.push_back({i, j});
+		}
+		sweep_.achievedBW[i][j] = achieved;
+		speed_[i][j] = achieved/sweep_.standaloneBW[i]*100;
+		pending_.erase(remove(pending_.begin(), pending_.end(), make_pair(i, j)), pending_.end());
+		if (pending_.empty()) refit();
+}
+
+// per normal kernel, the unmeasured cells that may hold its reduction
+// crossing (behind TBWDC) or the column where its slope flattens (its balance
+// point): everything strictly between the nearest measured cells around the
+// position the filled sweep gives
+void Planner::find_windows()
+{
+		int n = sweep_.standaloneBW.size(), m = sweep_.externalBW.size();
+		const vector<double> &sa = sweep_.standaloneBW, &ext = sweep_.externalBW;
+		const PccsModel &p = model_;
+		cross_lo_.assign(n, 0); cross_hi_.assign(n, -1);
+		bal_lo_.assign(n, 0); bal_hi_.assign(n, -1);
+		unresolved_ = 0;
+		normal_lo_ = normal_hi_ = 0;
+
+		Regions regions;
+		PccsModel bounds;
+		if (find_regions(sweep_, speed_, 0, regions, bounds) != 0 || !regions.minor) return;
+		double reduction = regions.reduction;
+		const FitThresholds &th = regions.thresholds;
+		normal_lo_ = regions.normal_boundary;
+		normal_hi_ = regions.intensive_boundary;
+
+		for (int i = normal_lo_; i < normal_hi_; ++i)
+		{
+				int j = 0;
+				while (j < m && (100 - speed_[i][j]) < reduction * th.normal_factor) ++j;
+				int lo = j - 1, hi = j;
+				while (lo >= 0 && !measured_[i*m + lo]) --lo;
+				while (hi < m && !measured_[i*m + hi]) ++hi;
+				cross_lo_[i] = lo; cross_hi_[i] = hi;
+
+				double sum = 0; int cnt = 0;
+				for (j = 1; j < m; ++j)
+				{
+						if (sa[i] + ext[j] < p.TBWDC) continue;
+						double cur = (speed_[i][j-1]-speed_[i][j])/(ext[j]-ext[j-1]);
+						if (cnt != 0 && cur * th.balance_factor < sum/cnt) break;
+						sum += cur; cnt++;
+				}
+				lo = j - 2; hi = j;
+				while (lo >= 0 && !measured_[i*m + lo]) --lo;
+				while (hi < m && !measured_[i*m + hi]) ++hi;
+				bal_lo_[i] = lo; bal_hi_[i] = hi;
+
+				for (j = 0; j < m; ++j)
+						unresolved_ += !measured_[i*m + j] && ((j > cross_lo_[i] && j < cross_hi_[i]) ||
+						                                      (j > bal_lo_[i] && j < bal_hi_[i]));
+		}
+}
+
+// fill unmeasured cells by interpolating relative speed along each row
+// (flat past the outermost measurement, 100% for an unmeasured row) and fit
+void Planner::refit()
+{
+		int n = sweep_.standaloneBW.size(), m = sweep_.externalBW.size();
+		const vector<double> &ext = sweep_.externalBW;
+		double PBW = 0;
+		for (int i = 0; i < n; ++i)
+		{
+				const char *known = &measured_[i*m];
+				for (int j = 0; j < m; ++j)
+						if (known[j]) PBW = max(PBW, sweep_.achievedBW[i][j]);
+				refill_row(speed_[i], speed_[i], m, ext, [&](int j) { return known[j] != 0; });
+		}
+
+		PccsModel fitted;
+		int status = fit(sweep_, speed_, PBW, fitted);
+		const double a[6] = {fitted.normal_BW, fitted.intensive_BW, fitted.MRMC, fitted.TBWDC, fitted.CBP, fitted.rate_i};
+		const double b[6] = {model_.normal_BW, model_.intensive_BW, model_.MRMC, model_.TBWDC, model_.CBP, model_.rate_i};
+		// a fit that is failing or has undefined parameters never counts as stable
+		bool same = status == 0 && status_ == 0;
+		for (int k = 0; k < 6 && same; ++k)
+				same = isfinite(a[k]) && fabs(a[k] - b[k]) <= options_.tolerance * max(fabs(b[k]), 1e-9);
+		stable_ = same ? stable_ + 1 : 0;
+		model_ = fitted;
+		status_ = status;
+		find_windows();
+		int patience = options_.patience > 0 ? options_.patience : n + m;
+		converged_ = stable_ >= patience && unresolved_ == 0;
+}
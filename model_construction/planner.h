@@ -0,0 +1,87 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <utility>
+#include <vector>
+
+#include "matrix.h"
+#include "pccs.h"
+
+struct PlannerOptions
+{
+		double tolerance = 0.01;   // relative change counted as "no change"
+		int patience = 0;          // unchanged refits in a row to call it converged, 0 = n + m
+		int per_round = 1;         // cells proposed between refits
+		double budget = 1.0;       // stop after this fraction of the grid
+};
+
+// fill the cells of one row of relative speeds for which known(j) is false:
+// linear in external BW between the nearest known cells, flat past the
+// outermost, 100% when none is known. Known cells are copied from src to
+// dst, which may be src itself
+template <class Known>
+void refill_row(const double *src, double *dst, int m, const std::vector<double> &ext, Known known)
+{
+		int left = -1;
+		for (int j = 0; j <= m; ++j)
+		{
+				if (j < m && !known(j)) continue;
+				if (j < m) dst[j] = src[j];
+				for (int k = left + 1; k < j; ++k)
+				{
+						if (left < 0 && j == m) dst[k] = 100;
+						else if (left < 0) dst[k] = src[j];
+						else if (j == m) dst[k] = src[left];
+						else dst[k] = src[left] + (src[j] - src[left]) * (ext[k] - ext[left]) / (ext[j] - ext[left]);
+				}
+				left = j;
+		}
+}
+
+// chooses which co-run cells of an n x m sweep to measure next.
+// The two outer columns of every row are measured first, since the
+// minor/normal and normal/intensive boundaries are read from them. After
+// that each unmeasured cell is filled by linear interpolation of relative
+// speed along its row, the filled sweep is refit, and cells are ranked by
+// how wide their interpolation gap is, weighted up inside the normal region
+// where a kernel's reduction crossing may lie, below CBP (where rate_i is
+// averaged), near the TBWDC diagonal and near the CBP column, plus how far
+// the current model disagrees with the interpolated value there.
+class Planner
+{
+public:
+		Planner(const std::vector<double> &standaloneBW, const std::vector<double> &externalBW,
+		        const PlannerOptions &options = PlannerOptions());
+
+		// cells to run next (kernel index, external index); empty when done
+		std::vector<std::pair<int, int> > next();
+
+		// store a measurement and refit once the round is complete
+		void record(int i, int j, double achieved);
+
+		bool done() const { return converged_ || budget_left() == 0 || measured_count_ == total(); }
+		bool converged() const { return converged_; }
+		const PccsModel &model() const { return model_; }
+		int status() const { return status_; }
+		int measured_count() const { return measured_count_; }
+		const std::vector<std::pair<int, int> > &history() const { return history_; }
+
+private:
+		int total() const { return sweep_.standaloneBW.size() * sweep_.externalBW.size(); }
+		int budget_left() const;
+		void refit();
+		void find_windows();
+
+		Sweep sweep_;
+		Matrix speed_;
+		std::vector<char> measured_;
+		std::vector<std::pair<int, int> > history_, pending_;
+		std::vector<int> cross_lo_, cross_hi_, bal_lo_, bal_hi_;
+		PlannerOptions options_;
+		PccsModel model_;
+		int status_ = -1, measured_count_ = 0, stable_ = 0, unresolved_ = 0;
+		int normal_lo_ = 0, normal_hi_ = 0;       // normal-region rows [lo, hi)
+		bool converged_ = false, seeded_ = false;
+};
+
+#endif
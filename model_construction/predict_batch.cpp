@@ -0,0 +1,179 @@
+#include <algorithm>
+
+#include "predict_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_KERNEL 1
+#endif
+
+// the vector kernels mirror predict_relative_speed() operation by operation;
+// std::min(a, b) is (b < a) ? b : a, which is what minpd(b, a) computes, and
+// std::max(a, b) likewise maps to maxpd(b, a), so NaN parameters propagate
+// the same way. Build this file with -ffp-contract=off so no FMA sneaks in.
+
+using namespace std;
+
+static void predict_scalar(const PccsModel &model, const double *own_bw,
+                           const double *external_bw, double *out, size_t count)
+{
+		for (size_t k = 0; k < count; ++k)
+				out[k] = predict_relative_speed(model, own_bw[k], external_bw[k]);
+}
+
+#ifdef HAVE_X86_KERNELS
+
+__attribute__((target("avx2")))
+static void predict_avx2(const PccsModel &model, const double *own_bw,
+                         const double *external_bw, double *out, size_t count)
+{
+		const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0), hundred = _mm256_set1_pd(100.0);
+		const __m256d normal_BW = _mm256_set1_pd(model.normal_BW), intensive_BW = _mm256_set1_pd(model.intensive_BW);
+		const __m256d MRMC = _mm256_set1_pd(model.MRMC), TBWDC = _mm256_set1_pd(model.TBWDC);
+		const __m256d CBP = _mm256_set1_pd(model.CBP), rate_i = _mm256_set1_pd(model.rate_i);
+		const bool has_cbp = model.CBP > 0;
+
+		size_t k = 0;
+		for (; k + 4 <= count; k += 4)
+		{
+				__m256d own = _mm256_loadu_pd(own_bw + k), ext = _mm256_loadu_pd(external_bw + k);
+
+				__m256d c_minor = has_cbp ? _mm256_min_pd(one, _mm256_div_pd(ext, CBP)) : one;
+				__m256d loss_minor = _mm256_mul_pd(MRMC, c_minor);
+
+				__m256d below_intensive = _mm256_cmp_pd(own, intensive_BW, _CMP_LT_OQ);
+				__m256d onset = _mm256_and_pd(below_intensive, _mm256_max_pd(zero, _mm256_sub_pd(TBWDC, own)));
+				__m256d c = _mm256_max_pd(zero, _mm256_sub_pd(_mm256_min_pd(CBP, ext), onset));
+				__m256d loss_normal = _mm256_mul_pd(rate_i, c);
+
+				__m256d minor = _mm256_cmp_pd(own, normal_BW, _CMP_LT_OQ);
+				__m256d loss = _mm256_blendv_pd(loss_normal, loss_minor, minor);
+				__m256d rs = _mm256_min_pd(hundred, _mm256_max_pd(zero, _mm256_sub_pd(hundred, loss)));
+				_mm256_storeu_pd(out + k, rs);
+		}
+		predict_scalar(model, own_bw + k, external_bw + k, out + k, count - k);
+}
+
+// GCC 12's _mm512_min_pd/_mm512_max_pd trip a false -Wmaybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+static void predict_avx512(const PccsModel &model, const double *own_bw,
+                           const double *external_bw, double *out, size_t count)
+{
+		const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.0), hundred = _mm512_set1_pd(100.0);
+		const __m512d normal_BW = _mm512_set1_pd(model.normal_BW), intensive_BW = _mm512_set1_pd(model.intensive_BW);
+		const __m512d MRMC = _mm512_set1_pd(model.MRMC), TBWDC = _mm512_set1_pd(model.TBWDC);
+		const __m512d CBP = _mm512_set1_pd(model.CBP), rate_i = _mm512_set1_pd(model.rate_i);
+		const bool has_cbp = model.CBP > 0;
+
+		size_t k = 0;
+		for (; k + 8 <= count; k += 8)
+		{
+				__m512d own = _mm512_loadu_pd(own_bw + k), ext = _mm512_loadu_pd(external_bw + k);
+
+				__m512d c_minor = has_cbp ? _mm512_min_pd(one, _mm512_div_pd(ext, CBP)) : one;
+				__m512d loss_minor = _mm512_mul_pd(MRMC, c_minor);
+
+				__mmask8 below_intensive = _mm512_cmp_pd_mask(own, intensive_BW, _CMP_LT_OQ);
+				__m512d onset = _mm512_maskz_mov_pd(below_intensive, _mm512_max_pd(zero, _mm512_sub_pd(TBWDC, own)));
+				__m512d c = _mm512_max_pd(zero, _mm512_sub_pd(_mm512_min_pd(CBP, ext), onset));
+				__m512d loss_normal = _mm512_mul_pd(rate_i, c);
+
+				__mmask8 minor = _mm512_cmp_pd_mask(own, normal_BW, _CMP_LT_OQ);
+				__m512d loss = _mm512_mask_blend_pd(minor, loss_normal, loss_minor);
+				__m512d rs = _mm512_min_pd(hundred, _mm512_max_pd(zero, _mm512_sub_pd(hundred, loss)));
+				_mm512_storeu_pd(out + k, rs);
+		}
+		predict_scalar(model, own_bw + k, external_bw + k, out + k, count - k);
+}
+#pragma GCC diagnostic pop
+
+#endif
+
+#ifdef HAVE_NEON_KERNEL
+
+// vminq/vmaxq return NaN for any NaN input, so spell out the std:: forms
+static inline float64x2_t min2(float64x2_t a, float64x2_t b) { return vbslq_f64(vcltq_f64(b, a), b, a); }
+static inline float64x2_t max2(float64x2_t a, float64x2_t b) { return vbslq_f64(vcltq_f64(a, b), b, a); }
+
+static void predict_neon(const PccsModel &model, const double *own_bw,
+                         const double *external_bw, double *out, size_t count)
+{
+		const float64x2_t zero = vdupq_n_f64(0.0), one = vdupq_n_f64(1.0), hundred = vdupq_n_f64(100.0);
+		const float64x2_t normal_BW = vdupq_n_f64(model.normal_BW), intensive_BW = vdupq_n_f64(model.intensive_BW);
+		const float64x2_t MRMC = vdupq_n_f64(model.MRMC), TBWDC = vdupq_n_f64(model.TBWDC);
+		const float64x2_t CBP = vdupq_n_f64(model.CBP), rate_i = vdupq_n_f64(model.rate_i);
+		const bool has_cbp = model.CBP > 0;
+
+		size_t k = 0;
+		for (; k + 2 <= count; k += 2)
+		{
+				float64x2_t own = vld1q_f64(own_bw + k), ext = vld1q_f64(external_bw + k);
+
+				float64x2_t c_minor = has_cbp ? min2(vdivq_f64(ext, CBP), one) : one;
+				float64x2_t loss_minor = vmulq_f64(MRMC, c_minor);
+
+				uint64x2_t below_intensive = vcltq_f64(own, intensive_BW);
+				float64x2_t onset = vbslq_f64(below_intensive, max2(vsubq_f64(TBWDC, own), zero), zero);
+				float64x2_t c = max2(vsubq_f64(min2(ext, CBP), onset), zero);
+				float64x2_t loss_normal = vmulq_f64(rate_i, c);
+
+				uint64x2_t minor = vcltq_f64(own, normal_BW);
+				float64x2_t loss = vbslq_f64(minor, loss_minor, loss_normal);
+				float64x2_t rs = min2(max2(vsubq_f64(hundred, loss), zero), hundred);
+				vst1q_f64(out + k, rs);
+		}
+		predict_scalar(model, own_bw + k, external_bw + k, out + k, count - k);
+}
+
+#endif
+
+predict_batch_fn predict_batch_kernel(PredictIsa isa)
+{
+		switch (isa)
+		{
+		case ISA_SCALAR:
+				return predict_scalar;
+#ifdef HAVE_X86_KERNELS
+		case ISA_AVX2:
+				return __builtin_cpu_supports("avx2") ? predict_avx2 : nullptr;
+		case ISA_AVX512:
+				return __builtin_cpu_supports("avx512f") ? predict_avx512 : nullptr;
+#endif
+#ifdef HAVE_NEON_KERNEL
+		case ISA_NEON:
+				return predict_neon;
+#endif
+		default:
+				return nullptr;
+		}
+}
+
+PredictIsa predict_batch_isa()
+{
+		static const PredictIsa best = [] {
+				const PredictIsa order[] = {ISA_AVX512, ISA_AVX2, ISA_NEON};
+				for (PredictIsa isa : order)
+						if (predict_batch_kernel(isa)) return isa;
+				return ISA_SCALAR;
+		}();
+		return best;
+}
+
+const char *predict_isa_name(PredictIsa isa)
+{
+		static const char *names[ISA_COUNT] = {"scalar", "avx2", "avx512", "neon"};
+		return isa < ISA_COUNT ? names[isa] : "unknown";
+}
+
+void predict_relative_speed_batch(const PccsModel &model, const double *own_bw,
+                                  const double *external_bw, double *out, size_t count)
+{
+		static const predict_batch_fn fn = predict_batch_kernel(predict_batch_isa());
+		fn(model, own_bw, external_bw, out, count);
+}
@@ -0,0 +1,26 @@
+#ifndef PREDICT_BATCH_H
+#define PREDICT_BATCH_H
+
+#include <stddef.h>
+
+#include "pccs.h"
+
+enum PredictIsa { ISA_SCALAR, ISA_AVX2, ISA_AVX512, ISA_NEON, ISA_COUNT };
+
+// out[k] = predict_relative_speed(model, own_bw[k], external_bw[k]) for k < count;
+// every variant gives the same bits as the scalar model
+typedef void (*predict_batch_fn)(const PccsModel &model, const double *own_bw,
+                                 const double *external_bw, double *out, size_t count);
+
+// the kernel for one instruction set, or nullptr if this build or CPU lacks it
+predict_batch_fn predict_batch_kernel(PredictIsa isa);
+
+// widest instruction set usable on this CPU (resolved once)
+PredictIsa predict_batch_isa();
+const char *predict_isa_name(PredictIsa isa);
+
+// batch entry point, dispatched to predict_batch_isa()
+void predict_relative_speed_batch(const PccsModel &model, const double *own_bw,
+                                  const double *external_bw, double *out, size_t count);
+
+#endif
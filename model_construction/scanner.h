@@ -0,0 +1,66 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <stdint.h>
+#include <charconv>
+
+// whitespace-separated numbers in [p, end); next() returns false, leaving p
+// on the offending character, when no number starts there
+struct Scanner
+{
+		const char *p, *end;
+
+		void skip_ws()
+		{
+				while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == '\v' || *p == '\f')) ++p;
+				if (p < end && *p == '+') ++p;
+		}
+
+		bool next(double &v)
+		{
+				skip_ws();
+				if (fast_decimal(v)) return true;
+				auto r = std::from_chars(p, end, v);
+				if (r.ec != std::errc()) return false;
+				p = r.ptr;
+				return true;
+		}
+
+		// plain "123.456" tokens with at most 19 significant digits; the value is
+		// exact when the mantissa fits in 53 bits and the scale is a power of ten
+		// that is itself exact (Clinger's fast path), anything else goes to from_chars
+		bool fast_decimal(double &v)
+		{
+				static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+				                               1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+				                               1e20, 1e21, 1e22};
+				const char *q = p;
+				bool neg = false;
+				if (q < end && *q == '-') { neg = true; ++q; }
+				uint64_t mant = 0;
+				int digits = 0, frac = 0;
+				while (q < end && (unsigned)(*q - '0') < 10) { mant = mant * 10 + (*q - '0'); ++q; ++digits; }
+				if (q < end && *q == '.')
+				{
+						++q;
+						while (q < end && (unsigned)(*q - '0') < 10) { mant = mant * 10 + (*q - '0'); ++q; ++digits; ++frac; }
+				}
+				if (digits == 0 || digits > 19 || frac > 22 || mant >> 53) return false;
+				if (q < end && (*q == 'e' || *q == 'E' || *q == 'x' || *q == 'X' || *q == 'n' || *q == 'N' || *q == 'i' || *q == 'I')) return false;
+				v = (double)mant / pow10[frac];
+				if (neg) v = -v;
+				p = q;
+				return true;
+		}
+
+		bool next(int &v)
+		{
+				skip_ws();
+				auto r = std::from_chars(p, end, v);
+				if (r.ec != std::errc()) return false;
+				p = r.ptr;
+				return true;
+		}
+};
+
+#endif
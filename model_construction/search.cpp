@@ -0,0 +1,107 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "parallel.h"
+#include "search.h"
+
+using namespace std;
+
+int read_grid(const char *path, ThresholdGrid &grid)
+{
+		FILE *fp = fopen(path, "r");
+		if (fp == NULL) { fprintf(stderr, "%s: cannot open\n", path); return -1; }
+		char line[4096];
+		while (fgets(line, sizeof line, fp))
+		{
+				char *hash = strchr(line, '#');
+				if (hash) *hash = 0;
+				char *name = strtok(line, " \t\r\n");
+				if (name == NULL) continue;
+				vector<double> *list = strcmp(name, "minor") == 0 ? &grid.minor
+				                     : strcmp(name, "normal_factor") == 0 ? &grid.normal_factor
+				                     : strcmp(name, "balance_factor") == 0 ? &grid.balance_factor : nullptr;
+				if (list == nullptr)
+				{
+						fprintf(stderr, "%s: unknown cut-off '%s'\n", path, name);
+						fclose(fp);
+						return -1;
+				}
+				list->clear();
+				for (char *tok; (tok = strtok(NULL, " \t\r\n")); ) list->push_back(atof(tok));
+		}
+		fclose(fp);
+		return 0;
+}
+
+// RMS distance between the model's prediction and the measured relative speed
+static double prediction_error(const Sweep &sweep, const Matrix &speed, const PccsModel &model)
+{
+		int n = sweep.standaloneBW.size(), m = sweep.externalBW.size();
+		double sum = 0;
+		for (int i = 0; i < n; ++i)
+		{
+				const double *s = speed[i];
+				for (int j = 0; j < m; ++j)
+				{
+						double d = predict_relative_speed(model, sweep.standaloneBW[i], sweep.externalBW[j]) - s[j];
+						sum += d * d;
+				}
+		}
+		return sqrt(sum / ((double)n * m));
+}
+
+int threshold_search(const Sweep &sweep, const ThresholdGrid &grid, vector<SearchResult> &results,
+                     unsigned threads)
+{
+		results.clear();
+		for (double minor : grid.minor)
+				for (double normal : grid.normal_factor)
+						for (double balance : grid.balance_factor)
+						{
+								SearchResult r;
+								r.thresholds.minor = minor;
+								r.thresholds.normal_factor = normal;
+								r.thresholds.balance_factor = balance;
+								results.push_back(r);
+						}
+		if (results.empty() || sweep.standaloneBW.empty() || sweep.externalBW.empty()) return -1;
+
+		Matrix speed;
+		double PBW = relative_speed(sweep, speed);
+
+		if (threads == 0) threads = default_threads();
+		threads = min(threads, (unsigned)results.size());
+		vector<FitWorkspace> ws(threads);
+		parallel_for(results.size(), [&](size_t k, unsigned worker) {
+				SearchResult &r = results[k];
+				r.status = fit(sweep, speed, PBW, r.model, &ws[worker], r.thresholds);
+				r.error = r.status == 0 ? prediction_error(sweep, speed, r.model) : NAN;
+		}, threads);
+
+		int best = -1;
+		for (size_t k = 0; k < results.size(); ++k)
+				if (results[k].status == 0 && isfinite(results[k].error)
+				    && (best < 0 || results[k].error < results[best].error))
+						best = k;
+		return best;
+}
+
+void write_search(FILE *fp, const vector<SearchResult> &results, int best)
+{
+		if (best >= 0)
+		{
+				const SearchResult &b = results[best];
+				write_model(fp, b.model);
+				fprintf(fp, "minor %lf\nnormal_factor %lf\nbalance_factor %lf\nerror %lf\n",
+				        b.thresholds.minor, b.thresholds.normal_factor, b.thresholds.balance_factor, b.error);
+		}
+		fprintf(fp, "# minor normal_factor balance_factor error normal_BW intensive_BW MRMC TBWDC CBP rate_i status\n");
+		for (const SearchResult &r : results)
+		{
+				const PccsModel &p = r.model;
+				fprintf(fp, "%g %g %g %lf %lf %lf %lf %lf %lf %lf %d\n",
+				        r.thresholds.minor, r.thresholds.normal_factor, r.thresholds.balance_factor, r.error,
+				        p.normal_BW, p.intensive_BW, p.MRMC, p.TBWDC, p.CBP, p.rate_i, r.status);
+		}
+}
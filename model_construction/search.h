@@ -0,0 +1,39 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "pccs.h"
+
+// candidate values for each cut-off; every combination is fitted
+struct ThresholdGrid
+{
+		std::vector<double> minor{70, 75, 80, 85, 90};
+		std::vector<double> normal_factor{1.5, 2, 2.5, 3};
+		std::vector<double> balance_factor{2, 3, 4, 5};
+};
+
+struct SearchResult
+{
+		FitThresholds thresholds;
+		int status = -1;          // fit() status; the candidate is only scored when 0
+		PccsModel model;
+		double error = 0;         // RMS of predicted - measured relative speed over all cells
+};
+
+// "minor 70 75 80" style lines, one per cut-off, '#' comments; cut-offs the
+// file leaves out keep the default list. returns -1 if unreadable
+int read_grid(const char *path, ThresholdGrid &grid);
+
+// fit the sweep with every grid combination on `threads` workers (0 = all
+// cores), sharing one relative speed matrix, and score each model against the
+// measured speeds. results are in grid order (minor outermost); returns the
+// index of the lowest error (the first one on ties), or -1 if nothing fitted
+int threshold_search(const Sweep &sweep, const ThresholdGrid &grid, std::vector<SearchResult> &results,
+                     unsigned threads = 0);
+
+// the best model in write_model's format, its cut-offs, then every candidate
+void write_search(FILE *fp, const std::vector<SearchResult> &results, int best);
+
+#endif
@@ -0,0 +1,106 @@
+#include <math.h>
+#include <vector>
+
+#include "surface.h"
+
+using namespace std;
+
+// the endpoint slope of the three-point formula, limited so that it keeps
+// the sign of the first secant and stays within three times it
+static double end_slope(double h0, double h1, double d0, double d1)
+{
+		double s = ((2 * h0 + h1) * d0 - h0 * d1) / (h0 + h1);
+		if (s * d0 <= 0) return 0;
+		if (d0 * d1 <= 0 && fabs(s) > fabs(3 * d0)) return 3 * d0;
+		return s;
+}
+
+int pchip_slopes(const double *x, const double *y, int count, double *d)
+{
+		if (count < 2) { if (count == 1) d[0] = 0; return 0; }
+		vector<double> h(count - 1), delta(count - 1);
+		for (int k = 0; k + 1 < count; ++k)
+		{
+				h[k] = x[k+1] - x[k];
+				if (!(h[k] > 0)) return -1;
+				delta[k] = (y[k+1] - y[k]) / h[k];
+		}
+		if (count == 2) { d[0] = d[1] = delta[0]; return 0; }
+		for (int k = 1; k + 1 < count; ++k)
+		{
+				if (delta[k-1] * delta[k] <= 0) { d[k] = 0; continue; }
+				double w1 = 2 * h[k] + h[k-1], w2 = h[k] + 2 * h[k-1];
+				d[k] = (w1 + w2) / (w1 / delta[k-1] + w2 / delta[k]);
+		}
+		d[0] = end_slope(h[0], h[1], delta[0], delta[1]);
+		d[count-1] = end_slope(h[count-2], h[count-3], delta[count-2], delta[count-3]);
+		return 0;
+}
+
+double pchip_eval(const double *x, const double *y, const double *d, int k, double t)
+{
+		double h = x[k+1] - x[k], t2 = t * t, t3 = t2 * t;
+		return (2*t3 - 3*t2 + 1) * y[k] + (t3 - 2*t2 + t) * h * d[k]
+		     + (-2*t3 + 3*t2) * y[k+1] + (t3 - t2) * h * d[k+1];
+}
+
+// the fine axis, and for each fine point the interval and fraction it lies at
+static void split_axis(const vector<double> &coarse, int factor, vector<double> &fine,
+                       vector<int> &interval, vector<double> &fraction)
+{
+		int count = coarse.size();
+		fine.clear(); interval.clear(); fraction.clear();
+		for (int k = 0; k + 1 < count; ++k)
+				for (int s = 0; s < factor; ++s)
+				{
+						double t = (double)s / factor;
+						fine.push_back(s == 0 ? coarse[k] : coarse[k] + (coarse[k+1] - coarse[k]) * t);
+						interval.push_back(k);
+						fraction.push_back(t);
+				}
+		if (count > 0)
+		{
+				fine.push_back(coarse[count-1]);
+				interval.push_back(count > 1 ? count - 2 : 0);
+				fraction.push_back(count > 1 ? 1.0 : 0.0);
+		}
+}
+
+int refine_sweep(const Sweep &coarse, int factor, Sweep &fine)
+{
+		if (factor < 1) return -1;
+		int n = coarse.standaloneBW.size(), m = coarse.externalBW.size();
+		Matrix speed;
+		relative_speed(coarse, speed);
+
+		vector<int> row_at, col_at;
+		vector<double> row_t, col_t;
+		split_axis(coarse.standaloneBW, factor, fine.standaloneBW, row_at, row_t);
+		split_axis(coarse.externalBW, factor, fine.externalBW, col_at, col_t);
+		int N = fine.standaloneBW.size(), M = fine.externalBW.size();
+
+		// along each measured row first
+		Matrix rows(n, M);
+		vector<double> d(max(n, m)), column(n);
+		for (int i = 0; i < n; ++i)
+		{
+				const double *s = speed[i];
+				if (pchip_slopes(coarse.externalBW.data(), s, m, d.data()) != 0) return -1;
+				for (int j = 0; j < M; ++j)
+						rows[i][j] = m > 1 ? pchip_eval(coarse.externalBW.data(), s, d.data(), col_at[j], col_t[j]) : s[0];
+		}
+		// then down every fine column
+		fine.achievedBW.resize(N, M);
+		for (int j = 0; j < M; ++j)
+		{
+				for (int i = 0; i < n; ++i) column[i] = rows[i][j];
+				if (pchip_slopes(coarse.standaloneBW.data(), column.data(), n, d.data()) != 0) return -1;
+				for (int i = 0; i < N; ++i)
+				{
+						double s = n > 1 ? pchip_eval(coarse.standaloneBW.data(), column.data(), d.data(), row_at[i], row_t[i])
+						                 : column[0];
+						fine.achievedBW[i][j] = s * fine.standaloneBW[i] / 100;
+				}
+		}
+		return 0;
+}
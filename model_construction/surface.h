@@ -0,0 +1,24 @@
+#ifndef SURFACE_H
+#define SURFACE_H
+
+#include "pccs.h"
+
+// monotone piecewise cubic (Fritsch-Carlson / PCHIP) through (x[k], y[k]),
+// x strictly increasing: the curve passes through every point, is monotone
+// wherever the data are, and never overshoots a local extremum. Writes the
+// slopes at the points to d; returns 0, or -1 if x is not increasing
+int pchip_slopes(const double *x, const double *y, int count, double *d);
+
+// evaluate the interpolant on [x[k], x[k+1]] at fraction t
+double pchip_eval(const double *x, const double *y, const double *d, int k, double t);
+
+// resample a sweep onto a grid `factor` times finer along both axes: every
+// interval between measured standalone and external BWs is split evenly,
+// and relative speed is interpolated with PCHIP first along each kernel's
+// row, then down each fine column. Measured points are kept exactly, so
+// fitting the fine sweep can place TBWDC, CBP and the region boundaries
+// between measured levels. returns 0, or -1 if factor < 1 or a BW axis is
+// not increasing
+int refine_sweep(const Sweep &coarse, int factor, Sweep &fine);
+
+#endif
@@ -0,0 +1,100 @@
+// regression checks for detect_drift(); `make check` builds and runs them
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "drift.h"
+#include "input.h"
+
+using namespace std;
+
+static int failures = 0;
+static vector<string> written;         // removed again before exiting
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); ++failures; } } while (0)
+
+// a sweep whose fit has a minor region but no normal kernels, so fit()
+// returns 0 with TBWDC and rate_i = 0/0
+static Sweep no_normal_sweep()
+{
+		Sweep s;
+		s.standaloneBW = {10, 20, 30};
+		s.externalBW = {10, 20};
+		s.achievedBW.resize(3, 2);
+		const double bw[3][2] = {{9.5, 9}, {12, 10}, {15, 12}};
+		for (int i = 0; i < 3; ++i)
+				for (int j = 0; j < 2; ++j) s.achievedBW[i][j] = bw[i][j];
+		return s;
+}
+
+static string write_run(const string &dir, int k, const Sweep &sweep)
+{
+		char name[64];
+		snprintf(name, sizeof(name), "/run%03d.txt", k);
+		string path = dir + name;
+		if (write_input(path.c_str(), sweep) != 0) exit(2);
+		written.push_back(path);
+		return path;
+}
+
+// every run NaN in TBWDC and rate_i: used to recurse without end
+static void all_nan_series(const string &dir)
+{
+		vector<string> inputs;
+		for (int k = 0; k < 8; ++k) inputs.push_back(write_run(dir, k, no_normal_sweep()));
+		vector<DriftRun> runs;
+		vector<ChangePoint> changes;
+		detect_drift(inputs, runs, changes);
+		CHECK(runs.size() == 8);
+		CHECK(runs[0].status == 0 && isnan(runs[0].model.TBWDC));
+		CHECK(changes.empty());
+}
+
+// a real shift with NaN runs mixed in: found, and reported with finite means
+static void shift_with_nan_runs(const string &dir)
+{
+		Sweep base;
+		if (read_input("input.txt", base) != 0) exit(2);
+		vector<string> inputs;
+		for (int k = 0; k < 24; ++k)
+		{
+				if (k % 5 == 2) { inputs.push_back(write_run(dir, 100 + k, no_normal_sweep())); continue; }
+				Sweep s = base;
+				double f = k < 12 ? 1.0 : 0.9;
+				for (int i = 4; i < s.achievedBW.rows(); ++i)
+						for (int j = 2; j < s.achievedBW.cols(); ++j)
+								s.achievedBW[i][j] *= f * (1 + 1e-3 * ((k * 7 + i * 3 + j) % 5));
+				inputs.push_back(write_run(dir, 100 + k, s));
+		}
+		vector<DriftRun> runs;
+		vector<ChangePoint> changes;
+		detect_drift(inputs, runs, changes);
+		bool surface = false;
+		for (const ChangePoint &c : changes)
+		{
+				CHECK(isfinite(c.before) && isfinite(c.after_value) && isfinite(c.shift));
+				CHECK(c.after + 1 < runs.size());
+				if (c.series != "surface") continue;
+				// the shift is after run 11; NaN run 12 is left out of the series
+				CHECK(c.after >= 10 && c.after <= 12);
+				surface |= c.after >= 10 && c.after <= 12;
+		}
+		CHECK(surface);
+}
+
+int main()
+{
+		char tmpl[] = "/tmp/pccs_drift_XXXXXX";
+		if (mkdtemp(tmpl) == NULL) { perror("mkdtemp"); return 2; }
+		string dir = tmpl;
+		all_nan_series(dir);
+		shift_with_nan_runs(dir);
+		for (const string &path : written) remove(path.c_str());
+		if (rmdir(dir.c_str()) != 0) perror(dir.c_str());
+		if (failures) { fprintf(stderr, "%d check(s) failed\n", failures); return 1; }
+		printf("test_drift: ok\n");
+		return 0;
+}
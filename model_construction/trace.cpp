@@ -0,0 +1,168 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "corun.h"
+#include "scanner.h"
+#include "trace.h"
+
+using namespace std;
+
+// room for the longest token; a number or "duration bw" line never gets near it
+#define TRACE_BUFFER (1 << 20)
+#define TRACE_TOKEN 256
+
+int TraceReader::open(const char *path)
+{
+		close();
+		path_ = path;
+		fd_ = ::open(path, O_RDONLY);
+		if (fd_ < 0) { fprintf(stderr, "%s: cannot open trace\n", path); return -1; }
+		posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+		buf_.resize(TRACE_BUFFER);
+		pos_ = len_ = bytes_ = 0;
+		eof_ = failed_ = false;
+		return 0;
+}
+
+void TraceReader::close()
+{
+		if (fd_ >= 0) ::close(fd_);
+		fd_ = -1;
+}
+
+// make at least `want` unread bytes available unless the file ends first
+bool TraceReader::fill(size_t want)
+{
+		if (len_ - pos_ >= want || eof_) return len_ > pos_;
+		memmove(buf_.data(), buf_.data() + pos_, len_ - pos_);
+		len_ -= pos_;
+		pos_ = 0;
+		while (len_ < buf_.size() && !eof_)
+		{
+				ssize_t got = ::read(fd_, buf_.data() + len_, buf_.size() - len_);
+				if (got < 0) { fprintf(stderr, "%s: read error\n", path_.c_str()); failed_ = eof_ = true; break; }
+				if (got == 0) eof_ = true;
+				len_ += got;
+				bytes_ += got;
+		}
+		return len_ > pos_;
+}
+
+bool TraceReader::next(double &duration, double &bw)
+{
+		if (fd_ < 0 || failed_) return false;
+		for (;;)
+		{
+				if (!fill(TRACE_TOKEN)) return false;
+				char c = buf_[pos_];
+				if (c == '#')
+				{
+						// comments may be longer than the look-ahead
+						for (;;)
+						{
+								const char *nl = (const char *)memchr(buf_.data() + pos_, '\n', len_ - pos_);
+								if (nl) { pos_ = nl - buf_.data(); break; }
+								pos_ = len_;
+								if (!fill(1)) return false;
+						}
+				}
+				else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') ++pos_;
+				else break;
+		}
+		// both numbers of a line fit in the look-ahead
+		fill(2 * TRACE_TOKEN);
+		Scanner s{buf_.data() + pos_, buf_.data() + len_};
+		if (!s.next(duration) || !s.next(bw) || duration < 0)
+		{
+				fprintf(stderr, "%s: bad interval near byte %zu\n", path_.c_str(), bytes_ - (len_ - pos_));
+				failed_ = true;
+				return false;
+		}
+		pos_ = s.p - buf_.data();
+		return true;
+}
+
+int replay_traces(const vector<ReplayApp> &apps, vector<ReplayStats> &stats, size_t *bytes)
+{
+		size_t count = apps.size();
+		vector<TraceReader> readers(count);
+		stats.assign(count, ReplayStats());
+		for (size_t k = 0; k < count; ++k)
+				if (readers[k].open(apps[k].trace.c_str()) != 0) return -1;
+
+		// per app: standalone time left in the current interval and its BW;
+		// the co-run set holds the apps still running
+		vector<double> left(count, 0), bw(count, 0);
+		vector<char> active(count, 1);
+		vector<CorunPu> set;
+		vector<size_t> owner;
+		vector<double> rate(count, 0);
+		CorunResult result;
+		double now = 0;
+		size_t running = count;
+		bool changed = true;
+
+		// load the next interval of app k, or retire it at the end of its trace
+		auto advance = [&](size_t k) {
+				double duration, demand;
+				while (readers[k].next(duration, demand))
+				{
+						stats[k].intervals++;
+						stats[k].standalone_time += duration;
+						if (duration == 0) continue;
+						left[k] = duration;
+						changed |= demand != bw[k];
+						bw[k] = demand;
+						return;
+				}
+				active[k] = 0;
+				stats[k].corun_time = now;
+				changed = true;
+				--running;
+		};
+		for (size_t k = 0; k < count; ++k) advance(k);
+
+		while (running > 0)
+		{
+				// traces often repeat a BW level; solve only when the demands change
+				if (changed)
+				{
+						set.clear(); owner.clear();
+						for (size_t k = 0; k < count; ++k)
+								if (active[k])
+								{
+										CorunPu pu;
+										pu.model = apps[k].model;
+										pu.standalone_bw = bw[k];
+										set.push_back(pu);
+										owner.push_back(k);
+								}
+						predict_corun(set.data(), set.size(), result);
+						for (size_t i = 0; i < set.size(); ++i)
+								rate[owner[i]] = max(result.relative_speed[i] / 100, 1e-9);
+						changed = false;
+				}
+
+				size_t first = count;
+				double dt = INFINITY;
+				for (size_t k = 0; k < count; ++k)
+						if (active[k] && left[k] / rate[k] < dt) { dt = left[k] / rate[k]; first = k; }
+				now += dt;
+				for (size_t k = 0; k < count; ++k)
+				{
+						if (!active[k]) continue;
+						left[k] -= rate[k] * dt;
+						if (k == first || left[k] <= 1e-12 * max(left[k] + rate[k] * dt, 1.0)) advance(k);
+				}
+		}
+
+		size_t total = 0;
+		bool failed = false;
+		for (size_t k = 0; k < count; ++k) { total += readers[k].bytes(); failed |= readers[k].failed(); }
+		if (bytes) *bytes = total;
+		return failed ? -1 : 0;
+}
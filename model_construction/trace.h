@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "pccs.h"
+
+// sequential reader of a bandwidth trace: one "duration bw" pair per
+// interval (seconds of standalone run time, GB/s demanded), '#' comments.
+// Reads through a fixed buffer, so memory does not grow with the trace.
+class TraceReader
+{
+public:
+		TraceReader() {}
+		TraceReader(const TraceReader &) = delete;
+		TraceReader &operator=(const TraceReader &) = delete;
+		~TraceReader() { close(); }
+
+		// returns 0, or -1 (message on stderr)
+		int open(const char *path);
+		void close();
+
+		// false at the end of the trace or on a malformed interval (see failed())
+		bool next(double &duration, double &bw);
+		bool failed() const { return failed_; }
+		size_t bytes() const { return bytes_; }
+
+private:
+		bool fill(size_t want);
+
+		std::string path_;
+		int fd_ = -1;
+		std::vector<char> buf_;
+		size_t pos_ = 0, len_ = 0, bytes_ = 0;
+		bool eof_ = false, failed_ = false;
+};
+
+// one co-running application: the model of the PU it runs on and its trace
+struct ReplayApp
+{
+		PccsModel model;
+		std::string trace;
+};
+
+struct ReplayStats
+{
+		long intervals = 0;
+		double standalone_time = 0;   // sum of the trace's durations
+		double corun_time = 0;        // when it finished in the co-run
+		double slowdown() const { return standalone_time > 0 ? corun_time / standalone_time : 1; }
+};
+
+// replay the apps' traces against each other in one pass. Every app moves
+// through its own trace at the relative speed predict_corun() gives for the
+// BWs all apps demand at that moment, so a slowed-down app's later phases
+// meet the others later, as they would on the device; an app that has
+// finished no longer adds demand. Only the current interval of each trace is
+// held in memory. stats[k] belongs to apps[k]; bytes (if given) receives the
+// total trace size read. returns 0, or -1 if a trace cannot be read
+int replay_traces(const std::vector<ReplayApp> &apps, std::vector<ReplayStats> &stats,
+                  size_t *bytes = nullptr);
+
+#endif
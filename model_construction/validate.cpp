@@ -0,0 +1,149 @@
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "parallel.h"
+#include "planner.h"
+#include "validate.h"
+
+using namespace std;
+
+namespace {
+
+struct HeldOut
+{
+		int region;
+		double error;
+};
+
+// per worker: the refilled speed matrix and the fit's scratch space
+struct FoldSpace
+{
+		Matrix speed;
+		vector<char> held;
+		FitWorkspace ws;
+};
+
+ValidationStats summarize(vector<double> &errors)
+{
+		ValidationStats s;
+		s.cells = errors.size();
+		if (errors.empty()) return s;
+		sort(errors.begin(), errors.end());
+		double sum = 0;
+		for (double e : errors) sum += e;
+		s.mean = sum / errors.size();
+		double pos = 0.95 * (errors.size() - 1);
+		size_t lo = (size_t)pos;
+		s.p95 = lo + 1 < errors.size() ? errors[lo] + (errors[lo+1] - errors[lo]) * (pos - lo) : errors.back();
+		s.max = errors.back();
+		return s;
+}
+
+}
+
+int cross_validate(const Sweep &sweep, int folds, ValidationResult &result, unsigned threads,
+                   unsigned long long seed)
+{
+		result = ValidationResult();
+		int n = sweep.standaloneBW.size(), m = sweep.externalBW.size();
+		const vector<double> &ext = sweep.externalBW;
+		Matrix speed;
+		double PBW = relative_speed(sweep, speed);
+		Regions regions;
+		PccsModel full;
+		int status = find_regions(sweep, speed, PBW, regions, full);
+		if (status != 0) return status;
+
+		vector<int> row_region(n, VALID_NORMAL);
+		if (regions.minor)
+				for (int i = 0; i < n; ++i)
+						row_region[i] = i < regions.normal_boundary ? VALID_MINOR
+						              : i < regions.intensive_boundary ? VALID_NORMAL : VALID_INTENSIVE;
+
+		// fold of every cell
+		vector<int> fold_of((size_t)n * m);
+		if (folds > 0)
+		{
+				vector<size_t> cells(fold_of.size());
+				for (size_t c = 0; c < cells.size(); ++c) cells[c] = c;
+				mt19937_64 rng(seed);
+				shuffle(cells.begin(), cells.end(), rng);
+				for (size_t k = 0; k < cells.size(); ++k) fold_of[cells[k]] = k % folds;
+		}
+		else
+		{
+				folds = m;
+				for (size_t c = 0; c < fold_of.size(); ++c) fold_of[c] = c % m;
+		}
+		result.folds = folds;
+
+		if (threads == 0) threads = default_threads();
+		threads = min(threads, (unsigned)folds);
+		vector<FoldSpace> space(threads);
+		vector<vector<HeldOut> > scored(folds);
+		vector<long> missed(folds, 0);
+		vector<char> fitted(folds, 0);
+
+		parallel_for(folds, [&](size_t f, unsigned worker) {
+				FoldSpace &w = space[worker];
+				w.speed.resize(n, m);
+				w.held.assign((size_t)n * m, 0);
+				double PBW_f = 0;
+				long held = 0;
+				for (size_t c = 0; c < fold_of.size(); ++c)
+						if (fold_of[c] == (int)f) { w.held[c] = 1; ++held; }
+
+				// refill held-out cells along each row, as the planner fills unmeasured ones
+				for (int i = 0; i < n; ++i)
+				{
+						const char *h = &w.held[(size_t)i * m];
+						for (int j = 0; j < m; ++j)
+								if (!h[j]) PBW_f = max(PBW_f, sweep.achievedBW[i][j]);
+						refill_row(speed[i], w.speed[i], m, ext, [&](int j) { return h[j] == 0; });
+				}
+
+				PccsModel model;
+				// too few kept cells below CBP leave rate_i undefined
+				bool ok = fit(sweep, w.speed, PBW_f, model, &w.ws) == 0;
+				for (double p : {model.normal_BW, model.intensive_BW, model.MRMC, model.TBWDC, model.CBP, model.rate_i})
+						ok = ok && isfinite(p);
+				if (!ok) { missed[f] = held; return; }
+				fitted[f] = 1;
+				vector<HeldOut> &out = scored[f];
+				out.reserve(held);
+				for (int i = 0; i < n; ++i)
+						for (int j = 0; j < m; ++j)
+								if (w.held[(size_t)i * m + j])
+								{
+										double predicted = predict_relative_speed(model, sweep.standaloneBW[i], ext[j]);
+										HeldOut h = {row_region[i], fabs(predicted - speed[i][j])};
+										out.push_back(h);
+								}
+		}, threads);
+
+		vector<double> errors[VALID_REGIONS];
+		for (int f = 0; f < folds; ++f)
+		{
+				result.fitted += fitted[f];
+				result.unscored += missed[f];
+				for (const HeldOut &h : scored[f])
+				{
+						errors[h.region].push_back(h.error);
+						errors[VALID_ALL].push_back(h.error);
+				}
+		}
+		for (int r = 0; r < VALID_REGIONS; ++r) result.region[r] = summarize(errors[r]);
+		return 0;
+}
+
+void write_validation(FILE *fp, const ValidationResult &result)
+{
+		static const char *names[VALID_REGIONS] = {"minor", "normal", "intensive", "all"};
+		fprintf(fp, "# region cells mean p95 max (|predicted - measured| relative speed, %d folds, "
+		        "%d fitted, %ld cells unscored)\n", result.folds, result.fitted, result.unscored);
+		for (int r = 0; r < VALID_REGIONS; ++r)
+				fprintf(fp, "%s %ld %lf %lf %lf\n", names[r], result.region[r].cells, result.region[r].mean,
+				        result.region[r].p95, result.region[r].max);
+}
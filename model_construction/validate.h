@@ -0,0 +1,40 @@
+#ifndef VALIDATE_H
+#define VALIDATE_H
+
+#include <stdio.h>
+
+#include "pccs.h"
+
+enum ValidationRegion { VALID_MINOR, VALID_NORMAL, VALID_INTENSIVE, VALID_ALL, VALID_REGIONS };
+
+// absolute prediction error on held-out cells, in percentage points of
+// relative speed
+struct ValidationStats
+{
+		long cells = 0;
+		double mean = 0, p95 = 0, max = 0;
+};
+
+struct ValidationResult
+{
+		int folds = 0;
+		int fitted = 0;                      // folds whose refit succeeded with finite parameters
+		long unscored = 0;                   // held-out cells of folds that did not fit
+		ValidationStats region[VALID_REGIONS];
+};
+
+// cross-validate the fit of a sweep. folds > 0 splits the cells at random
+// (seeded) into that many folds; folds == 0 holds out one external BW column
+// at a time. Each fold's cells are refilled by interpolating relative speed
+// along their rows, as the planner does for unmeasured cells, the sweep is
+// refit, and the refit predicts the held-out cells. Folds run in parallel on
+// `threads` workers (0 = all cores). A cell's region is its kernel's region
+// in the fit of the whole sweep; without a minor region every row counts as
+// normal. returns the status of that fit (folds only run when it is 0)
+int cross_validate(const Sweep &sweep, int folds, ValidationResult &result, unsigned threads = 0,
+                   unsigned long long seed = 1);
+
+// "region cells mean p95 max" for minor, normal, intensive and all cells
+void write_validation(FILE *fp, const ValidationResult &result);
+
+#endif
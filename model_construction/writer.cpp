@@ -0,0 +1,77 @@
+#include <math.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <charconv>
+
+#include "writer.h"
+
+using namespace std;
+
+#define WRITER_BUFFER (1 << 20)
+#define WRITER_NUMBER 32          // longest to_chars output of a double or long
+
+int BufferedWriter::open(const char *path, const char *nonfinite)
+{
+		close();
+		path_ = path;
+		nonfinite_ = nonfinite;
+		fd_ = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd_ < 0) { fprintf(stderr, "%s: cannot open output file\n", path); return -1; }
+		buf_.resize(WRITER_BUFFER);
+		len_ = 0;
+		failed_ = false;
+		return 0;
+}
+
+int BufferedWriter::close()
+{
+		if (fd_ < 0) return 0;
+		flush();
+		if (::close(fd_) != 0) failed_ = true;
+		fd_ = -1;
+		if (failed_) { fprintf(stderr, "%s: write error\n", path_.c_str()); return -1; }
+		return 0;
+}
+
+// write(2) all of [s, s + len), recording a failure instead of stopping the caller
+static void write_all(int fd, const char *s, size_t len, bool &failed)
+{
+		while (len > 0 && !failed)
+		{
+				ssize_t wrote = ::write(fd, s, len);
+				if (wrote < 0) { failed = true; break; }
+				s += wrote;
+				len -= wrote;
+		}
+}
+
+void BufferedWriter::flush()
+{
+		write_all(fd_, buf_.data(), len_, failed_);
+		len_ = 0;
+}
+
+void BufferedWriter::put(const char *s, size_t len)
+{
+		if (len_ + len > buf_.size()) flush();
+		// longer than the whole buffer: straight through
+		if (len > buf_.size()) { write_all(fd_, s, len, failed_); return; }
+		memcpy(buf_.data() + len_, s, len);
+		len_ += len;
+}
+
+void BufferedWriter::put(double v)
+{
+		if (!isfinite(v)) { put(nonfinite_); return; }
+		if (len_ + WRITER_NUMBER > buf_.size()) flush();
+		char *end = to_chars(buf_.data() + len_, buf_.data() + buf_.size(), v).ptr;
+		len_ = end - buf_.data();
+}
+
+void BufferedWriter::put(long v)
+{
+		if (len_ + WRITER_NUMBER > buf_.size()) flush();
+		char *end = to_chars(buf_.data() + len_, buf_.data() + buf_.size(), v).ptr;
+		len_ = end - buf_.data();
+}
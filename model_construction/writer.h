@@ -0,0 +1,45 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// sequential writer to a file through a fixed buffer, which is written out
+// whenever it fills and on close() or destruction. Numbers are formatted
+// with std::to_chars (shortest text that reads back to the same double),
+// without stdio's locale and format parsing; non-finite values are written
+// as `nonfinite`.
+class BufferedWriter
+{
+public:
+		BufferedWriter() {}
+		BufferedWriter(const BufferedWriter &) = delete;
+		BufferedWriter &operator=(const BufferedWriter &) = delete;
+		~BufferedWriter() { close(); }
+
+		// both return 0, or -1 (message on stderr); close() flushes, and reports
+		// any write error since open()
+		int open(const char *path, const char *nonfinite = "nan");
+		int close();
+
+		void put(const char *s) { put(s, strlen(s)); }
+		void put(const std::string &s) { put(s.data(), s.size()); }
+		void put(const char *s, size_t len);
+		void put(char c) { if (len_ == buf_.size()) flush(); buf_[len_++] = c; }
+		void put(double v);
+		void put(long v);
+
+private:
+		void flush();
+
+		std::string path_;
+		std::string nonfinite_;
+		int fd_ = -1;
+		std::vector<char> buf_;
+		size_t len_ = 0;
+		bool failed_ = false;
+};
+
+#endif
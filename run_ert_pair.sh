@@ -40,6 +40,7 @@ run_and_collect() {          # $1=DIR  $2=EXE  $3=OUTFILE
       case "$line" in
         BW:*) set -- $line; echo "$2" >> "$OUT" ;;  
         *)    set -- $line; [ $# -ge 2 ] || continue
+              case "$2" in ''|*[!0-9]*) continue ;; esac    # PLACEMENT etc.
               [ "$2" -ge 5 ] && kill "$PID" 2>/dev/null ;;
       esac
     done <"$FIFO"